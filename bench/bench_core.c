@@ -0,0 +1,367 @@
+// bench/bench_core.c
+// Microbenchmarks of the game core's hot functions, run in isolation on a
+// private (not shared) one-table directory. Each case is warmed up while
+// its batch size is calibrated, then timed over REPS batches. malloc is
+// interposed to count allocations. Results go to stdout as JSON so runs
+// can be diffed across commits. Usage: bench_core [name filter]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "game_state.h"
+#include "game_logic.h"
+#include "shared_mem.h"
+#include "logger.h"
+#include "protocol.h"
+#include "rules.h"
+#include "shoe.h"
+#include "scores.h"
+#include "spectator.h"
+#include "odds.h"
+#include "network.h"
+#include "stats.h"
+
+#define REPS 7
+#define BATCH_NS 20000000LL      // Calibrated batch length (20 ms)
+#define HANDS 4096               // Pre-dealt hands for calculate_points
+#define SEATED 3                 // Players at the benchmark table
+
+// --- 1. ALLOCATION COUNTING ---
+
+// glibc's own entry points; every malloc in the process, libc's internal
+// ones (fopen, ...) included, comes through the wrappers below
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static _Atomic uint64_t alloc_calls;
+static _Atomic uint64_t alloc_bytes;
+
+static void count_alloc(size_t size) {
+    atomic_fetch_add_explicit(&alloc_calls, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&alloc_bytes, size, memory_order_relaxed);
+}
+
+void *malloc(size_t size) {
+    count_alloc(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size) {
+    count_alloc(n * size);
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    count_alloc(size);
+    return __libc_realloc(ptr, size);
+}
+
+// --- 2. FIXTURE ---
+
+static TableDirectory *dir;
+static GameState *gs;
+static int hands[HANDS][MAX_CARDS];
+static int hand_len[HANDS];
+static volatile unsigned sink;   // Keeps results observable
+
+// Score-file and log writes land in a scratch directory
+static char scratch[] = "/tmp/bench_core.XXXXXX";
+
+static void seat_players(void) {
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        PlayerState *p = &gs->players[i];
+        memset(p, 0, sizeof(*p));
+        p->player_id = i;
+        p->connected = i < SEATED;
+        p->active = p->connected;
+    }
+}
+
+static int setup_fixture(void) {
+    // GameState is cache-line aligned, as it is in the mmap()ed directory
+    size_t size = sizeof(TableDirectory) + sizeof(GameState);
+    dir = aligned_alloc(CACHE_LINE, (size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE);
+    if (!dir) return -1;
+    memset(dir, 0, size);
+    dir->table_count = 1;
+    gs = &dir->tables[0];
+    gs->table_id = 0;
+    ShoeConfig cfg = { DEFAULT_DECKS, DEFAULT_PENETRATION, 1 };
+    init_game_state_struct(gs, &cfg);
+    seat_players();
+    reset_game_round(gs);
+
+    Rng rng;
+    rng_seed(&rng, 1, 0);
+    for (int h = 0; h < HANDS; h++) {
+        hand_len[h] = 2 + (int)rng_below(&rng, 4);
+        for (int c = 0; c < hand_len[h]; c++) hands[h][c] = 1 + (int)rng_below(&rng, 13);
+    }
+    return 0;
+}
+
+// --- 3. CASES ---
+
+// Draws with the cut-card check reset_game_round() does; with no shuffler
+// thread every swap shuffles its spare inline, amortized in ns/op
+static void run_draw_card(long iters) {
+    for (long i = 0; i < iters; i++) {
+        sink += (unsigned)draw_card(gs);
+        if (shoe_past_cut(&gs->shoe)) shoe_swap(&gs->shoe);
+    }
+}
+
+// What shuffle_deck() became: one Fisher-Yates pass over a single deck
+static void run_shuffle_cards(long iters) {
+    static uint8_t cards[DECK_SIZE];
+    static Rng rng;
+    if (cards[0] == 0) {
+        rng_seed(&rng, 1, 0);
+        for (int i = 0; i < DECK_SIZE; i++) cards[i] = (uint8_t)(i % 13 + 1);
+    }
+    for (long i = 0; i < iters; i++) {
+        shuffle_cards(cards, DECK_SIZE, &rng);
+        sink += cards[0];
+    }
+}
+
+// What init_deck() became: refill the spare shoe inline and switch to it
+static void run_shoe_swap(long iters) {
+    for (long i = 0; i < iters; i++) {
+        shoe_swap(&gs->shoe);
+        sink += gs->shoe.cards[0][0];
+    }
+}
+
+static void run_calculate_points(long iters) {
+    for (long i = 0; i < iters; i++) {
+        int h = (int)(i & (HANDS - 1));
+        sink += (unsigned)calculate_points(hands[h], hand_len[h]);
+    }
+}
+
+// Includes what it triggers: table wakeups, the END log record and
+// update_score() for every seat (re-armed: only a dealt round is settled)
+static void run_determine_winner(long iters) {
+    for (long i = 0; i < iters; i++) {
+        atomic_store(&gs->round_started_ns, stats_now());
+        determine_winner(gs);
+        sink += (unsigned)gs->winner;
+    }
+}
+
+// Resets and deals SEATED players, logging each card
+static void run_reset_game_round(long iters) {
+    for (long i = 0; i < iters; i++) {
+        reset_game_round(gs);
+        sink += (unsigned)gs->players[0].points;
+    }
+}
+
+// The STATE line handle_client() sends a text player (it used to sprintf
+// it), from a fresh table snapshot as the server takes one
+static void run_state_text(long iters) {
+    uint8_t frame[PROTO_MAX_FRAME];
+    char text[PROTO_TEXT_MAX];
+    TableSnapshot snap;
+    for (long i = 0; i < iters; i++) {
+        table_snapshot(gs, &snap);
+        size_t len = proto_state(frame, &snap, (int)(i % SEATED));
+        sink += (unsigned)proto_to_text((const ProtoHeader *)frame, text, sizeof(text)) + (unsigned)len;
+    }
+}
+
+// The binary equivalent: a DELTA against what the player was last sent
+static void run_state_delta(long iters) {
+    uint8_t frame[PROTO_MAX_FRAME];
+    StateView view = { .valid = false };
+    TableSnapshot snap;
+    for (long i = 0; i < iters; i++) {
+        gs->current_turn = (int)(i % SEATED);
+        table_snapshot(gs, &snap);
+        sink += (unsigned)proto_state_update(frame, &view, &snap, 0);
+    }
+}
+
+// One text turn through a Conn: STATE and prompt queued, one send() on a
+// socketpair whose other end is drained as it goes
+static void run_conn_turn(long iters) {
+    static int fds[2] = { -1, -1 };
+    static Conn conn;
+    char text[PROTO_TEXT_MAX], drain[4096];
+    uint8_t frame[PROTO_MAX_FRAME];
+    TableSnapshot snap;
+    if (fds[0] < 0) {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) return;
+        conn_init(&conn, fds[0], NULL, NULL);
+    }
+    table_snapshot(gs, &snap);
+    for (long i = 0; i < iters; i++) {
+        proto_state(frame, &snap, 0);
+        conn_queue(&conn, text, proto_to_text((const ProtoHeader *)frame, text, sizeof(text)));
+        proto_round(frame, EV_YOUR_TURN, 500);
+        conn_queue(&conn, text, proto_to_text((const ProtoHeader *)frame, text, sizeof(text)));
+        sink += (unsigned)conn_flush(&conn);
+        sink += (unsigned)read(fds[1], drain, sizeof(drain));
+    }
+}
+
+// What a spectator feed costs per table version: snapshot plus rendering
+// into the shared frame (the version moves every iteration)
+static void run_spectator_render(long iters) {
+    char frame[TABLE_FRAME_MAX];
+    uint32_t version;
+    for (long i = 0; i < iters; i++) {
+        atomic_fetch_add(&gs->state_version, 1);
+        sink += (unsigned)spectator_frame(gs, frame, &version);
+    }
+}
+
+// ...and per watcher process once it is rendered: a seqlocked copy
+static void run_spectator_frame(long iters) {
+    char frame[TABLE_FRAME_MAX];
+    uint32_t version;
+    for (long i = 0; i < iters; i++) sink += (unsigned)spectator_frame(gs, frame, &version);
+}
+
+// A card comes out, then what a turn prompt adds: the table's shoe counts
+// brought up to date and the chance a hit busts
+static void run_odds_turn(long iters) {
+    static ShoeCounts counts;
+    for (long i = 0; i < iters; i++) {
+        sink += (unsigned)draw_card(gs);
+        if (shoe_past_cut(&gs->shoe)) shoe_swap(&gs->shoe);
+        odds_sync(&counts, &gs->shoe);
+        sink += (unsigned)odds_bust_permille(&counts, 14);
+    }
+}
+
+// The same figure recounting the rest of the shoe every turn instead
+static void run_odds_recount(long iters) {
+    ShoeCounts counts;
+    for (long i = 0; i < iters; i++) {
+        sink += (unsigned)draw_card(gs);
+        if (shoe_past_cut(&gs->shoe)) shoe_swap(&gs->shoe);
+        uint32_t dealt = shoe_dealt(&gs->shoe);
+        if (dealt > (uint32_t)gs->shoe.size) dealt = (uint32_t)gs->shoe.size;
+        odds_count(&counts, gs->shoe.cards[SHOE_GEN(atomic_load(&gs->shoe.cursor)) & 1] + dealt,
+                   gs->shoe.size - (int)dealt);
+        sink += (unsigned)odds_bust_permille(&counts, 14);
+    }
+}
+
+static void run_log_event(long iters) {
+    for (long i = 0; i < iters; i++) log_event("BENCH", "Player 0 hit, 17 points");
+}
+
+static void run_update_score(long iters) {
+    for (long i = 0; i < iters; i++) update_score(0, (int)(i % SEATED), i % SEATED == 0, 17);
+}
+
+typedef struct {
+    const char *name;
+    void (*run)(long iters);
+} BenchCase;
+
+static const BenchCase cases[] = {
+    { "draw_card", run_draw_card },
+    { "shuffle_cards", run_shuffle_cards },
+    { "shoe_swap", run_shoe_swap },
+    { "calculate_points", run_calculate_points },
+    { "determine_winner", run_determine_winner },
+    { "reset_game_round", run_reset_game_round },
+    { "state_text", run_state_text },
+    { "state_delta", run_state_delta },
+    { "conn_turn", run_conn_turn },
+    { "spectator_render", run_spectator_render },
+    { "spectator_frame", run_spectator_frame },
+    { "odds_turn", run_odds_turn },
+    { "odds_recount", run_odds_recount },
+    { "log_event", run_log_event },
+    { "update_score", run_update_score },
+};
+
+// --- 4. HARNESS ---
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static long long time_batch(const BenchCase *c, long iters) {
+    long long t0 = now_ns();
+    c->run(iters);
+    return now_ns() - t0;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void run_case(FILE *json, const BenchCase *c, bool first) {
+    // Warmup doubles as calibration: grow the batch until it takes BATCH_NS
+    long iters = 1;
+    while (time_batch(c, iters) < BATCH_NS && iters < (1L << 40)) iters *= 2;
+    time_batch(c, iters);
+
+    double ns_op[REPS];
+    uint64_t calls0 = atomic_load(&alloc_calls), bytes0 = atomic_load(&alloc_bytes);
+    for (int r = 0; r < REPS; r++) ns_op[r] = (double)time_batch(c, iters) / (double)iters;
+    double ops = (double)iters * REPS;
+    double allocs = (double)(atomic_load(&alloc_calls) - calls0) / ops;
+    double bytes = (double)(atomic_load(&alloc_bytes) - bytes0) / ops;
+    qsort(ns_op, REPS, sizeof(double), cmp_double);
+
+    fprintf(json, "%s    {\"name\": \"%s\", \"iters\": %ld, \"ns_per_op\": %.2f, \"ns_min\": %.2f, "
+           "\"ns_max\": %.2f, \"ops_per_sec\": %.0f, \"allocs_per_op\": %.4f, \"bytes_per_op\": %.1f}",
+           first ? "" : ",\n", c->name, iters, ns_op[REPS / 2], ns_op[0], ns_op[REPS - 1],
+           1e9 / ns_op[REPS / 2], allocs, bytes);
+    fflush(json);
+}
+
+int main(int argc, char *argv[]) {
+    const char *filter = argc > 1 ? argv[1] : NULL;
+
+    // stdout carries only the JSON; the code under test chats on stderr
+    FILE *json = fdopen(dup(STDOUT_FILENO), "w");
+    if (!json || dup2(STDERR_FILENO, STDOUT_FILENO) < 0) {
+        perror("bench_core: stdout");
+        return 1;
+    }
+
+    if (!mkdtemp(scratch) || chdir(scratch) != 0) {
+        perror("bench_core: scratch directory");
+        return 1;
+    }
+    // The log ring is a named shm object: don't take over a live server's
+    bool ring = access("/dev/shm/blackjack_log", F_OK) != 0;
+    if (ring && init_logger(LOG_FULL_BLOCK) != 0) ring = false;
+    if (init_score_system(1) != 0 || setup_fixture() != 0) {
+        perror("bench_core: fixture");
+        return 1;
+    }
+
+    fprintf(json, "{\n  \"suite\": \"core\",\n  \"reps\": %d,\n  \"batch_ms\": %lld,\n  \"logger\": \"%s\",\n"
+           "  \"results\": [\n", REPS, BATCH_NS / 1000000, ring ? "ring" : "direct");
+    bool first = true;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        if (filter && !strstr(cases[i].name, filter)) continue;
+        run_case(json, &cases[i], first);
+        first = false;
+    }
+    fprintf(json, "\n  ]\n}\n");
+    fclose(json);
+
+    shutdown_score_system();
+    if (ring) shutdown_logger();
+    unlink("game.log");
+    unlink(SCORES_FILE);
+    if (chdir("/") == 0) rmdir(scratch);
+    return 0;
+}
@@ -0,0 +1,106 @@
+// bench/bench_draw.c
+// Latency of dealing a round (cut-card check + one card per seat), with
+// the spare shoe shuffled inline by the dealer versus by a background
+// shuffler woken on every retired shoe like the server's (shuffler.h).
+// Rounds are paced like a live table, so the shuffler gets to run.
+// Usage: bench_draw [rounds] [decks]
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include "shoe.h"
+#include "wait_queue.h"
+
+#define CARDS_PER_ROUND 6
+#define PAUSE_NS 100000       // Between rounds (fast bots; people are far slower)
+
+static Shoe shoe;
+static WaitQueue wq;
+static _Atomic int stop;
+static _Atomic uint32_t taken;
+static volatile unsigned sink;   // Keeps the draws observable
+
+static void count_swap(Shoe *s) {
+    (void)s;
+    atomic_fetch_add(&taken, 1);
+    wq_wake_all(&wq);
+}
+
+static void* shuffler(void *arg) {
+    (void)arg;
+    uint32_t swept = 0;
+    for (;;) {
+        uint32_t seen = wq_prepare(&wq);
+        if (atomic_load(&stop)) break;
+        uint32_t now = atomic_load(&taken);
+        if (now == swept) {
+            wq_wait(&wq, seen, -1);
+            continue;
+        }
+        swept = now;
+        shoe_fill_spare(&shoe);
+    }
+    return NULL;
+}
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int cmp_ll(const void *a, const void *b) {
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+static void run(const char *name, int rounds, int decks, bool background) {
+    ShoeConfig cfg = { decks, DEFAULT_PENETRATION, 1 };
+    long long *lat = malloc(sizeof(long long) * (size_t)rounds);
+    pthread_t tid;
+    int swaps = 0;
+
+    shoe_init(&shoe, &cfg, 0);
+    atomic_store(&stop, 0);
+    shoe_spare_hook = background ? count_swap : NULL;
+    if (background) pthread_create(&tid, NULL, shuffler, NULL);
+
+    struct timespec pause = { 0, PAUSE_NS };
+    for (int r = 0; r < rounds; r++) {
+        long long t0 = now_ns();
+        if (shoe_past_cut(&shoe)) {
+            shoe_swap(&shoe);
+            swaps++;
+        }
+        for (int c = 0; c < CARDS_PER_ROUND; c++) sink += (unsigned)shoe_draw(&shoe);
+        lat[r] = now_ns() - t0;
+        nanosleep(&pause, NULL);
+    }
+
+    if (background) {
+        atomic_store(&stop, 1);
+        wq_wake_all(&wq);
+        pthread_join(tid, NULL);
+    }
+    qsort(lat, (size_t)rounds, sizeof(long long), cmp_ll);
+    printf("%-11s %8d %8u %8lld %8lld %8lld %8lld\n", name, swaps, shoe.inline_fills,
+           lat[rounds / 2], lat[(int)(rounds * 0.99)], lat[(int)(rounds * 0.999)],
+           lat[rounds - 1]);
+    free(lat);
+}
+
+int main(int argc, char *argv[]) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 20000;
+    int decks = argc > 2 ? atoi(argv[2]) : MAX_DECKS;
+    if (rounds < 1000 || decks < 1 || decks > MAX_DECKS) {
+        fprintf(stderr, "Usage: %s [rounds >= 1000] [decks 1-%d]\n", argv[0], MAX_DECKS);
+        return 1;
+    }
+
+    printf("%d rounds of %d cards, %d deck(s); round latency in ns\n",
+           rounds, CARDS_PER_ROUND, decks);
+    printf("%-11s %8s %8s %8s %8s %8s %8s\n", "shuffle", "swaps", "inline", "p50", "p99", "p99.9", "max");
+    run("inline", rounds, decks, false);
+    run("background", rounds, decks, true);
+    return 0;
+}
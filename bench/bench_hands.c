@@ -0,0 +1,106 @@
+// bench/bench_hands.c
+// Scores the same batch of random hands with every implementation the CPU
+// supports, checks each against calculate_points()/pick_winner(), then
+// reports hands/sec. Usage: bench_hands [hands] [passes]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hand_batch.h"
+#include "rules.h"
+#include "rng.h"
+
+#define SEATS MAX_PLAYERS
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : (1u << 20);
+    int passes = argc > 2 ? atoi(argv[2]) : 20;
+    if (n == 0 || passes <= 0) {
+        fprintf(stderr, "Usage: %s [hands] [passes]\n", argv[0]);
+        return 1;
+    }
+
+    // n hands laid out as SEATS seats of n / SEATS tables
+    size_t tables = n / SEATS;
+    n = tables * SEATS;
+    uint8_t *cards[MAX_CARDS];
+    uint8_t *points = malloc(n), *connected = malloc(n);
+    uint8_t *expect = malloc(n), *winner = malloc(tables), *expect_win = malloc(tables);
+    for (int i = 0; i < MAX_CARDS; i++) cards[i] = calloc(n, 1);
+    if (!points || !connected || !expect || !winner || !expect_win) {
+        perror("malloc");
+        return 1;
+    }
+
+    // Hands of 2..MAX_CARDS cards, some seats empty, scored the old way
+    Rng rng;
+    rng_seed(&rng, 42, 0);
+    for (size_t t = 0; t < tables; t++) {
+        PlayerState table[SEATS];
+        memset(table, 0, sizeof(table));
+        for (int s = 0; s < SEATS; s++) {
+            size_t h = s * tables + t;
+            int count = 2 + (int)rng_below(&rng, MAX_CARDS - 1);
+            for (int i = 0; i < count; i++) {
+                add_card(&table[s], 1 + (int)rng_below(&rng, 13));
+                cards[i][h] = (uint8_t)table[s].cards[i];
+            }
+            table[s].connected = rng_below(&rng, 8) != 0;
+            expect[h] = (uint8_t)calculate_points(table[s].cards, count);
+            connected[h] = table[s].connected;
+        }
+        int w = pick_winner(table, SEATS);
+        expect_win[t] = w < 0 ? HAND_NO_WINNER : (uint8_t)w;
+    }
+
+    const uint8_t *cols[MAX_CARDS];
+    const uint8_t *seat_points[SEATS], *seat_conn[SEATS];
+    for (int i = 0; i < MAX_CARDS; i++) cols[i] = cards[i];
+    for (int s = 0; s < SEATS; s++) {
+        seat_points[s] = points + s * tables;
+        seat_conn[s] = connected + s * tables;
+    }
+
+    printf("%zu hands, %zu tables of %d, %d passes\n", n, tables, SEATS, passes);
+    printf("%-8s %14s %14s\n", "impl", "hands/sec", "tables/sec");
+
+    double scalar_rate = 0;
+    int failed = 0;
+    for (HandImpl want = HAND_IMPL_SCALAR; want <= HAND_IMPL_AVX2; want++) {
+        if (hand_batch_use(want) != want) {
+            printf("%-8s %14s\n", hand_impl_name(want), "unsupported");
+            continue;
+        }
+
+        memset(points, 0, n);
+        score_hands(cols, n, points);
+        pick_winners(seat_points, seat_conn, SEATS, tables, winner);
+        if (memcmp(points, expect, n) != 0 || memcmp(winner, expect_win, tables) != 0) {
+            printf("%-8s %14s\n", hand_impl_name(want), "MISMATCH");
+            failed = 1;
+            continue;
+        }
+
+        double start = now_sec();
+        for (int p = 0; p < passes; p++) score_hands(cols, n, points);
+        double hands_rate = (double)n * passes / (now_sec() - start);
+
+        start = now_sec();
+        for (int p = 0; p < passes; p++) pick_winners(seat_points, seat_conn, SEATS, tables, winner);
+        double tables_rate = (double)tables * passes / (now_sec() - start);
+
+        if (want == HAND_IMPL_SCALAR) scalar_rate = hands_rate;
+        printf("%-8s %14.0f %14.0f   (%.1fx scalar)\n", hand_impl_name(want),
+               hands_rate, tables_rate, scalar_rate > 0 ? hands_rate / scalar_rate : 0);
+    }
+
+    for (int i = 0; i < MAX_CARDS; i++) free(cards[i]);
+    free(points); free(connected); free(expect); free(winner); free(expect_win);
+    return failed;
+}
@@ -0,0 +1,58 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include "shoe.h"
+
+// Optional traffic capture (server --capture FILE) for bjreplay.
+//
+// Every byte a client connection sends or receives is appended to one
+// file as a record: a 16-byte header followed by the bytes themselves.
+// All processes share the file (O_APPEND, one writev() per record) plus a
+// clock base and a connection counter, so records of one connection are
+// in order and connection ids are unique server-wide. Fields are in host
+// byte order; the file is meant for the machine class that wrote it.
+
+#define CAPTURE_MAGIC "BJCAP"
+#define CAPTURE_VERSION 1
+
+typedef enum {
+    CAP_OPEN  = 1,   // Connection accepted (no payload)
+    CAP_IN    = 2,   // Bytes the server read from the client
+    CAP_OUT   = 3,   // Bytes the server sent to the client
+    CAP_CLOSE = 4    // Connection done (no payload)
+} CaptureKind;
+
+typedef struct {
+    char magic[6];          // "BJCAP\0"
+    uint16_t version;
+    uint16_t decks;         // Server shoe settings, so a replay can match them
+    uint16_t penetration;
+    uint32_t reserved;
+    uint64_t seed;
+} CaptureHeader;
+
+typedef struct {
+    uint64_t t_us;          // Microseconds since the capture started
+    uint32_t conn;          // Server-wide connection id, from 1
+    uint16_t len;           // Payload bytes that follow
+    uint8_t kind;           // CaptureKind
+    uint8_t reserved;
+} CaptureRecord;
+
+// Master, before fork(): creates FILE and the shared counters. -1 on error.
+int capture_open(const char *path, const ShoeConfig *shoe);
+void capture_close(void);
+
+// Start / end recording a client socket (no-ops when capture is off)
+void capture_conn_open(int fd);
+void capture_conn_close(int fd);
+
+// send()/recv() that also record what went over a registered socket.
+// MSG_PEEK reads are not recorded; the real read that follows is.
+ssize_t capture_send(int fd, const void *buf, size_t len, int flags);
+ssize_t capture_recv(int fd, void *buf, size_t len, int flags);
+
+#endif
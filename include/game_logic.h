@@ -1,12 +1,18 @@
 #ifndef GAME_LOGIC_H
 #define GAME_LOGIC_H
 
-// Calculate points based on Blackjack rules
-// Ace = 1 or 11, Face cards = 10
-int calculate_points(int cards[], int count);
+#include "game_state.h"
+#include "rules.h"
+
+// Deck Functions
+int draw_card(GameState *gs);
 
 // Game Control Functions
 void reset_game_round(GameState *gs);
 void determine_winner(GameState *gs);
 
+// Pass the turn to the next connected seat and flag game_over
+// once every connected player is standing (takes turn_sem)
+void advance_turn(GameState *gs);
+
 #endif
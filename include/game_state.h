@@ -4,27 +4,55 @@
 #include <stddef.h>
 #include <semaphore.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 #include <time.h>
+#include "wait_queue.h"
+#include "shoe.h"
 
 // Game Constants
 #define MAX_PLAYERS 5
 #define MAX_CARDS 10
-#define DECK_SIZE 52
+#define MAX_TABLES 4096
+#define DEFAULT_TABLES 64
+#define MAX_WORKERS 256
+#define CACHE_LINE 64
+#define TABLE_FRAME_MAX 640    // Largest spectator rendering of one table
 
 // Player State Structure
 typedef struct {
     int player_id;
     int cards[MAX_CARDS];
     int card_count;
-    int points;
+    int points;          // Best total; kept up to date by add_card()
+    int hard_total;      // Every ace counted as 1
+    int aces;            // Aces in the hand (at most one can count as 11)
     bool connected;
     bool active;
     bool standing;
     time_t last_active;
 } PlayerState;
 
+// The whole table as spectators see it (spectator.h), rendered once per
+// state_version by whichever process needs it first
+typedef struct {
+    _Atomic uint32_t seq;       // Odd while a process is rendering
+    _Atomic uint32_t version;   // state_version the text shows
+    _Atomic uint32_t len;       // 0 until first rendered
+    char data[TABLE_FRAME_MAX];
+} TableFrame;
+
 // Global Game State (Shared Memory Structure)
+// Fields are grouped by who writes them, each group on its own cache
+// lines, so the processes dealing, waiting and scheduling on one table do
+// not keep stealing each other's lines.
 typedef struct {
+    // Set up once by the master, read-only afterwards
+    int table_id;
+    int worker_id;      // Worker whose scheduler owns this table
+
+    // Game state, written under the table's sequence lock (table_write_begin()
+    // in shared_mem.h) and read as one consistent copy with table_snapshot()
+    _Alignas(CACHE_LINE) _Atomic uint32_t seq;  // Odd while a writer is inside
     PlayerState players[MAX_PLAYERS];
     int current_turn;
     int active_count;
@@ -34,17 +62,70 @@ typedef struct {
     int winner;
     int round_number; 
     
-    int deck[DECK_SIZE];
-    int deck_idx;
+    // Seeded per table (stream = table_id); lock-free draws
+    _Alignas(CACHE_LINE) Shoe shoe;
 
     // MEMBER 4: Synchronization primitives
     // These are placed directly in the struct to live in shared memory
-    sem_t deck_mutex; 
-    sem_t turn_sem;
+    _Alignas(CACHE_LINE) sem_t turn_sem;
     sem_t score_sem;
+
+    // Wakeups instead of usleep() polling (see wait_queue.h)
+    _Alignas(CACHE_LINE) WaitQueue table_wq;    // round, game_over or seating changed
+    WaitQueue seat_wq[MAX_PLAYERS];     // current_turn handed to this seat
+
+    // Turn timer bookkeeping for the owning scheduler (scheduler.c)
+    _Alignas(CACHE_LINE) _Atomic uint32_t turn_seq;     // Bumped on every turn handoff
+    _Atomic int sched_pending;          // Queued in the worker's event ring
+    _Atomic int event_slot;             // One slot of that ring (table_id + 1)
+
+    // Bumped on every notify; binary clients get STATE deltas against it
+    _Atomic uint32_t state_version;
+
+    // stats_now() stamps for the latency histograms (see stats.h)
+    _Atomic uint64_t turn_started_ns;   // Last turn handoff
+    _Atomic uint64_t round_started_ns;  // Cards dealt; 0 once the round is settled
+
+    // Written only by spectator_frame(), read by every process with watchers
+    _Alignas(CACHE_LINE) TableFrame frame;
 } GameState;
 
+// A consistent copy of a table's game state (see table_snapshot())
+typedef struct {
+    uint32_t seq;                       // Table version the copy was taken at
+    uint32_t state_version;
+    PlayerState players[MAX_PLAYERS];
+    int current_turn;
+    int connected_count;
+    bool game_active;
+    bool game_over;
+    int winner;
+    int round_number;
+} TableSnapshot;
+
+// Per-worker MPSC ring of tables that changed, drained by the scheduler.
+// Its storage is the event_slot of each table in the worker's range, so
+// capacity equals the table count; sched_pending dedups, so it never fills.
+typedef struct {
+    _Atomic uint32_t head;  // Consumer position
+    _Atomic uint32_t tail;  // Producers reserve here
+    int first;
+    int count;
+} TableEventRing;
+
+// Shared Memory Directory: a header followed by table_count independent
+// tables, each with its own deck, turn state and semaphores
+typedef struct {
+    int table_count;
+    _Atomic int open_hint;              // Next-fit start for seat routing (claim_seat())
+    WaitQueue worker_wq[MAX_WORKERS];   // Wakes a worker's scheduler thread
+    TableEventRing worker_ring[MAX_WORKERS];
+    _Atomic uint32_t spares_taken;      // Bumped when a table swaps in its spare shoe
+    WaitQueue shuffler_wq;              // Wakes the shuffler (a shoe was retired)
+    GameState tables[];
+} TableDirectory;
+
 // Function Prototypes
-void init_game_state_struct(GameState *gs);
+void init_game_state_struct(GameState *gs, const ShoeConfig *shoe);
 
 #endif
\ No newline at end of file
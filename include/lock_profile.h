@@ -0,0 +1,54 @@
+#ifndef LOCK_PROFILE_H
+#define LOCK_PROFILE_H
+
+#include <semaphore.h>
+#include "game_state.h"
+
+// The per-table semaphores, taken through TABLE_LOCK()/TABLE_UNLOCK().
+// A normal build turns those into plain sem_wait()/sem_post(). Built with
+// LOCK_PROFILE=1 (make rebuild LOCK_PROFILE=1), every acquisition is timed
+// and charged to its call site: how often, how often it had to wait, wait
+// time and hold time. The master prints the report on shutdown and, from
+// its main loop, after a SIGUSR1.
+
+typedef enum {
+    LOCK_TURN,          // gs->turn_sem
+    LOCK_SCORE,         // gs->score_sem
+    LOCK_KINDS
+} LockKind;
+
+static inline sem_t *table_sem(GameState *gs, LockKind kind) {
+    return kind == LOCK_TURN ? &gs->turn_sem : &gs->score_sem;
+}
+
+#ifdef LOCK_PROFILE
+
+#define LOCKPROF_SITES 32
+#define LOCKPROF_STR_(x) #x
+#define LOCKPROF_STR(x) LOCKPROF_STR_(x)
+
+// Shared with every forked process; call in the master before fork()
+int lockprof_init(int table_count);
+void lockprof_report(void);
+// Prints the report if a SIGUSR1 asked for one since the last call
+void lockprof_poll(void);
+
+void lockprof_acquire(GameState *gs, LockKind kind, const char *site, const char *func);
+void lockprof_release(GameState *gs, LockKind kind);
+
+#define TABLE_LOCK(gs, kind) \
+    lockprof_acquire((gs), (kind), __FILE__ ":" LOCKPROF_STR(__LINE__), __func__)
+#define TABLE_UNLOCK(gs, kind) lockprof_release((gs), (kind))
+
+#else
+
+#define lockprof_init(table_count) ((void)(table_count), 0)
+#define lockprof_report() ((void)0)
+#define lockprof_poll() ((void)0)
+
+#define TABLE_LOCK(gs, kind) sem_wait(table_sem((gs), (kind)))
+#define TABLE_UNLOCK(gs, kind) sem_post(table_sem((gs), (kind)))
+
+#endif
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <time.h>
+#include "wait_queue.h"
+
+#define LOG_FILE "game.log"
+#define LOG_RING_SIZE 4096     // Records in the shared ring (power of two)
+#define LOG_TYPE_LEN 8
+#define LOG_DETAIL_LEN 104
+#define LOG_FLUSH_MS 50        // Flusher batching interval
+
+// What a producer does when the ring is full
+typedef enum {
+    LOG_FULL_DROP,   // Count the record as dropped and return immediately
+    LOG_FULL_BLOCK   // Wait for the flusher to make room
+} LogFullPolicy;
+
+// One slot of the ring (128 bytes). seq tells producers and the flusher
+// whose turn the slot is (bounded MPMC queue, one consumer here).
+typedef struct {
+    _Atomic uint64_t seq;
+    time_t when;
+    char type[LOG_TYPE_LEN];
+    char details[LOG_DETAIL_LEN];
+} LogRecord;
+
+// Lives in its own shared memory object so forked children log into it
+typedef struct {
+    _Atomic uint64_t enqueue_pos;
+    char pad1[56];               // Producers and the flusher on separate lines
+    _Atomic uint64_t dequeue_pos;
+    _Atomic uint64_t dropped;
+    _Atomic int stopping;
+    LogFullPolicy policy;
+    WaitQueue data_wq;           // Flusher sleeps here
+    WaitQueue space_wq;          // Blocked producers sleep here
+    LogRecord records[LOG_RING_SIZE];
+} LogRing;
+
+// Map the ring and start the flusher thread (call once, before fork())
+int init_logger(LogFullPolicy policy);
+
+// Stop the flusher after it has written every record, then unmap
+void shutdown_logger(void);
+
+void log_event(const char* type, const char* details);
+void log_player_connect(int id);
+void log_player_disconnect(int id);
+void log_card_dealt(int id, int val);
+void log_player_action(int id, const char* act, int pts);
+void log_game_start(int count);
+void log_game_end(int winner);
+
+#endif
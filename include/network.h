@@ -1,10 +1,67 @@
 #ifndef NETWORK_H
 #define NETWORK_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
 // These are just declarations (blueprints)
 int connect_to_server(const char *ip);
+// Non-blocking: the socket turns writable once the connect is done, and
+// connect_result() then gives 0 or the errno it failed with
+int connect_to_server_async(const char *ip);
+int connect_result(int sock);
+// One recv(), NUL-terminated; no framing, so callers buffer lines themselves
 int receive_message(int sock, char *buf, int size);
+// Sends all of msg, however many send() calls that takes
 void send_message(int sock, const char *msg);
 void close_connection(int sock);
 
+#define CONN_IN_MAX 1024
+#define CONN_OUT_KEEP 4096    // Largest output buffer kept between flushes
+
+typedef ssize_t (*ConnSendFn)(int fd, const void *buf, size_t len, int flags);
+typedef ssize_t (*ConnRecvFn)(int fd, void *buf, size_t len, int flags);
+
+// Buffered connection. Reads land in 'in', so whatever arrives past the
+// current line or frame (pipelined commands, the rest of a split frame)
+// waits there for the next one. Writes queue in 'out' and leave together
+// on conn_flush(): one send() per turn rather than one per message.
+// Works on blocking and non-blocking sockets alike.
+typedef struct {
+    int fd;
+    ConnSendFn send_fn;
+    ConnRecvFn recv_fn;
+    char in[CONN_IN_MAX];
+    size_t in_start;        // First byte not consumed yet
+    size_t in_len;          // End of the bytes received
+    char *out;              // Allocated on first use, kept while at most CONN_OUT_KEEP
+    size_t out_len;
+    size_t out_cap;
+    bool failed;            // A send failed: the peer is gone, output is dropped
+} Conn;
+
+// NULL send_fn/recv_fn mean plain send()/recv() (capture.h has recording ones)
+void conn_init(Conn *c, int fd, ConnSendFn send_fn, ConnRecvFn recv_fn);
+// Drops queued output; the socket is left open
+void conn_free(Conn *c);
+
+// One recv() into the input buffer: bytes read, 0 once the peer closed,
+// -1 with errno set (EAGAIN on an empty non-blocking socket, ENOBUFS if
+// the buffer is full of input nobody consumed)
+ssize_t conn_fill(Conn *c);
+// Next complete line, without "\n" or "\r\n", NUL-terminated into line;
+// false if none is in yet. A full buffer with no newline counts as a line.
+bool conn_line(Conn *c, char *line, size_t cap);
+// Unconsumed input, for frame decoders, and how much of it they used
+const char* conn_data(const Conn *c, size_t *len);
+void conn_consume(Conn *c, size_t n);
+
+// Queues bytes for the next flush; false once the connection has failed
+bool conn_queue(Conn *c, const void *buf, size_t len);
+// Sends what is queued: 0 when all of it went, 1 if a non-blocking socket
+// is full (flush again once writable), -1 if the connection failed
+int conn_flush(Conn *c);
+size_t conn_pending(const Conn *c);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef ODDS_H
+#define ODDS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "shoe.h"
+
+// Exact odds for a hand against the cards still in a table's shoe, dealt
+// without replacement. ShoeCounts follows a live shoe incrementally: a
+// sync only subtracts the cards dealt since the last one, and recounts
+// only when the table moves on to a fresh shoe.
+
+#define ODDS_VALUES 10          // Card values: ace, 2-9, ten (10, J, Q, K)
+
+typedef struct {
+    uint16_t count[ODDS_VALUES];   // [v - 1]: cards of value v left
+    uint16_t total;
+    bool synced;                   // gen/dealt below are valid
+    uint32_t gen;                  // Shoe generation counted
+    uint32_t dealt;                // Cards of it already subtracted
+} ShoeCounts;
+
+// Final totals of one way of playing a hand; everything sums to 1
+typedef struct {
+    float total[22];            // Chance of ending on exactly t
+    float bust;
+} OddsDist;
+
+// Counts from a list of cards (1-13)
+void odds_count(ShoeCounts *c, const uint8_t *cards, int n);
+
+// Brings c up to date with the live shoe. A shoe with nothing left is
+// counted as the fresh one its next card will come from.
+void odds_sync(ShoeCounts *c, const Shoe *shoe);
+
+static inline void odds_remove(ShoeCounts *c, int card) {
+    int v = card >= 10 ? 10 : card;
+    if (c->count[v - 1] == 0) return;
+    c->count[v - 1]--;
+    c->total--;
+}
+
+// Chance that one more card busts a hand of this hard total, in 1/1000
+static inline int odds_bust_permille(const ShoeCounts *c, int hard_total) {
+    if (c->total == 0) return 0;
+    int busting = 0;
+    for (int v = 22 - hard_total; v <= ODDS_VALUES; v++) {
+        if (v >= 1) busting += c->count[v - 1];
+    }
+    return (busting * 1000 + c->total / 2) / c->total;
+}
+
+// Standing: the current total. Hitting: exactly one more card.
+void odds_stand(int hard_total, int aces, OddsDist *out);
+void odds_hit(const ShoeCounts *c, int hard_total, int aces, OddsDist *out);
+
+#endif
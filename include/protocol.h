@@ -0,0 +1,187 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "game_state.h"
+
+// Binary wire protocol, version 2.
+//
+// Every message is a frame: 2-byte big-endian payload length, 1-byte type,
+// then a fixed-layout payload made only of bytes (no padding, no alignment),
+// so a received frame is read in place without copying.
+//
+// A client opts in by sending PROTO_HELLO as its very first bytes, within
+// PROTO_HELLO_WINDOW_MS of connecting. Text commands never start with a NUL
+// byte, so the first byte alone tells the two protocols apart. Anyone who
+// stays silent gets the human-readable STATE:/MESSAGE: text protocol.
+//
+// Binary clients get a full STATE only now and then; in between, DELTA
+// frames carry just what changed since the version the client holds.
+// A client that finds a gap in the versions sends RESYNC.
+
+#define PROTO_VERSION 2
+#define PROTO_MAGIC_0 'B'
+#define PROTO_MAGIC_1 'J'
+#define PROTO_HELLO_WINDOW_MS 100
+#define PROTO_MAX_FRAME 64     // Largest frame either side ever sends
+#define PROTO_TEXT_MAX 256     // Largest text rendering of one frame
+#define PROTO_NO_PLAYER 0xFF
+#define PROTO_SNAPSHOT_EVERY 16   // Deltas between two full STATE frames
+
+typedef enum {
+    WIRE_TEXT,
+    WIRE_BINARY
+} WireMode;
+
+// Frame types: client -> server below 0x80, server -> client above
+typedef enum {
+    MSG_HELLO     = 0x01,
+    MSG_ACTION    = 0x02,
+    MSG_RESYNC    = 0x03,   // Empty payload: "send me a full STATE"
+    MSG_HELLO_ACK = 0x81,
+    MSG_STATE     = 0x82,
+    MSG_ROUND     = 0x83,
+    MSG_RESULT    = 0x84,
+    MSG_DELTA     = 0x85
+} ProtoType;
+
+// ACTION payload (hit/stand at a turn prompt, yes/no at a vote prompt)
+typedef enum {
+    ACT_NONE     = 0,
+    ACT_HIT      = 1,
+    ACT_STAND    = 2,
+    ACT_CONTINUE = 3,
+    ACT_LEAVE    = 4
+} ProtoAction;
+
+// ROUND payload: the table-level events the text protocol sends as MESSAGE:
+typedef enum {
+    EV_WAITING_PLAYERS = 1, // arg unused
+    EV_ROUND_START     = 2, // arg = round number
+    EV_NOT_YOUR_TURN   = 3, // arg = your seat
+    EV_YOUR_TURN       = 4, // arg = chance a hit busts, in 1/1000; reply with ACT_HIT / ACT_STAND
+    EV_CONTINUE_VOTE   = 5, // arg unused; reply with ACT_CONTINUE / ACT_LEAVE
+    EV_WAITING_VOTES   = 6, // arg unused
+    EV_LEAVING         = 7, // arg = your seat
+    EV_GAME_ENDING     = 8  // arg unused
+} RoundEvent;
+
+#define STATE_STANDING 0x01
+
+// DELTA 'changed' bits
+#define DELTA_TURN     0x01
+#define DELTA_POINTS   0x02
+#define DELTA_STANDING 0x04
+#define DELTA_CARDS    0x08
+
+typedef struct {
+    uint8_t len[2];
+    uint8_t type;
+} ProtoHeader;
+
+typedef struct {
+    uint8_t magic[2];
+    uint8_t version;
+} ProtoHello;
+
+typedef struct {
+    uint8_t version;
+    uint8_t seat;
+    uint8_t table[2];
+} ProtoHelloAck;
+
+typedef struct {
+    uint8_t version[2];   // Table state version (low 16 bits)
+    uint8_t turn;
+    uint8_t seat;
+    uint8_t points;
+    uint8_t flags;
+    uint8_t card_count;
+    uint8_t cards[MAX_CARDS];
+} ProtoState;
+
+// Variable length: the payload ends with the newly dealt cards only
+typedef struct {
+    uint8_t version[2];   // Version this delta brings the client to
+    uint8_t base[2];      // Version the client must hold to apply it
+    uint8_t changed;      // DELTA_* bits
+    uint8_t turn;
+    uint8_t points;
+    uint8_t flags;
+    uint8_t first_card;   // Hand index of cards[0]
+    uint8_t cards[];
+} ProtoDelta;
+
+typedef struct {
+    uint8_t event;
+    uint8_t arg[2];
+} ProtoRound;
+
+typedef struct {
+    uint8_t winner;   // PROTO_NO_PLAYER if nobody won
+    uint8_t points;
+} ProtoResult;
+
+typedef struct {
+    uint8_t action;
+} ProtoActionMsg;
+
+// Server side: what one binary connection has been told so far
+typedef struct {
+    ProtoState sent;
+    bool valid;            // false until the first STATE, or after RESYNC
+    int deltas;            // Deltas since the last full STATE
+} StateView;
+
+static inline uint16_t proto_get16(const uint8_t b[2]) {
+    return (uint16_t)((b[0] << 8) | b[1]);
+}
+
+static inline void proto_put16(uint8_t b[2], unsigned v) {
+    b[0] = (uint8_t)(v >> 8);
+    b[1] = (uint8_t)v;
+}
+
+static inline const void* proto_payload(const ProtoHeader *h) {
+    return h + 1;
+}
+
+// Encoders: write one whole frame into buf (PROTO_MAX_FRAME bytes) and
+// return its length
+size_t proto_hello(uint8_t *buf);
+size_t proto_hello_ack(uint8_t *buf, int seat, int table);
+size_t proto_action(uint8_t *buf, ProtoAction action);
+size_t proto_state(uint8_t *buf, const TableSnapshot *snap, int seat);
+size_t proto_round(uint8_t *buf, RoundEvent event, int arg);
+size_t proto_result(uint8_t *buf, int winner, int points);
+size_t proto_resync(uint8_t *buf);
+
+// Brings a connection's view up to date: a DELTA when only a few fields
+// moved, a full STATE when due (or the hand was re-dealt), 0 if nothing
+// the player can see has changed
+size_t proto_state_update(uint8_t *buf, StateView *view, const TableSnapshot *snap, int seat);
+
+// Client side: applies a DELTA to the last STATE payload received.
+// Returns false if it does not follow on from that version (send RESYNC).
+bool proto_apply_delta(ProtoState *state, const ProtoHeader *delta);
+
+// Legacy text line for a STATE payload
+size_t proto_state_text(const ProtoState *state, char *out, size_t cap);
+
+// Finds the frame at the start of buf. Returns its total length and points
+// *hdr at it, 0 if more bytes are needed, or -1 if the bytes are not a
+// valid frame (unknown type or wrong payload size).
+int proto_next_frame(const uint8_t *buf, size_t avail, const ProtoHeader **hdr);
+
+// True if the frame is a hello this server understands
+bool proto_is_hello(const ProtoHeader *hdr);
+
+// Renders a server -> client frame as the legacy text lines; returns length
+size_t proto_to_text(const ProtoHeader *hdr, char *out, size_t cap);
+
+// Maps a legacy text command ("hit", "stand", "yes", ...) to an action
+ProtoAction proto_parse_text(const char *line);
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include "game_state.h"
+#include "shared_mem.h"
+
+// Single-process event loop (--reactor mode)
+// Drives every session on the worker's tables from one edge-triggered
+// epoll instance instead of forking a blocking handle_client() per socket.
+// Spectators accepted on watch_sock are served from the same loop.
+// Players are seated at any worker's table (claim_seat()); a connection
+// seated at worker w's table is passed to it through handoff[w][1] and
+// picked up from handoff[w][0], a Unix datagram socketpair per worker.
+int run_reactor(int listen_sock, int watch_sock, TableRange *range, int (*handoff)[2]);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef RULES_H
+#define RULES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "game_state.h"
+
+// Pure table rules: no shared memory, locks or sockets, so the server and
+// the headless simulator (bjsim) play by exactly the same code.
+
+// Fewest cards a shoe may hold past its cut card (enough for one round)
+#define RESHUFFLE_THRESHOLD 20
+
+// Calculate points based on Blackjack rules
+// Ace = 1 or 11, Face cards = 10
+int calculate_points(const int *cards, int count);
+
+// Hard value of each rank (ace = 1, face cards = 10); index 0 is unused
+extern const uint8_t card_value[14];
+
+// Best total for a hand: one ace counts 11 when that does not bust
+static inline int hand_total(int hard_total, int aces) {
+    return (aces > 0 && hard_total <= 11) ? hard_total + 10 : hard_total;
+}
+
+// Appends a card and updates the totals in O(1), without rescanning the
+// hand. Returns false (hand unchanged) if the hand already holds MAX_CARDS.
+bool add_card(PlayerState *p, int card);
+
+// Checks below read the running totals only
+static inline bool hand_busted(const PlayerState *p) {
+    return p->hard_total > 21;
+}
+
+static inline bool hand_is_soft(const PlayerState *p) {
+    return p->aces > 0 && p->hard_total <= 11;
+}
+
+static inline bool hand_is_blackjack(const PlayerState *p) {
+    return p->card_count == 2 && p->points == 21;
+}
+
+void reset_player_state(PlayerState *p);
+
+// Highest total that did not bust wins (lowest seat on a tie); if everyone
+// busted, the first connected seat. -1 if no seat is connected.
+int pick_winner(const PlayerState *players, int count);
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef SCORES_H
+#define SCORES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// Leaderboard store: one fixed-size record per (table, seat) in a file
+// every server process maps MAP_SHARED. Counters are bumped in place with
+// atomic adds, so a lookup is an index and a win costs no I/O. A top-N
+// index of record numbers is kept sorted by wins on every win; readers
+// copy it under a seqlock.
+
+#define SCORES_FILE "scores.db"
+#define SCORES_MAGIC 0x424a5343u    // "BJSC"
+#define SCORES_VERSION 1
+#define SCORES_TOP_N 10
+
+typedef struct {
+    _Atomic uint64_t wins;
+    _Atomic uint64_t rounds;        // Rounds played to the end
+    _Atomic uint64_t points;        // Sum of final hands (busts count 0)
+} ScoreRecord;                      // Record number = table_id * MAX_PLAYERS + seat
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;              // Records in the file (tables * MAX_PLAYERS)
+    _Atomic uint32_t top_seq;       // Odd while top[] is being rewritten
+    _Atomic uint32_t top_lock;      // Serializes the writers of top[]
+    _Atomic uint32_t top_count;
+    _Atomic int32_t top[SCORES_TOP_N];  // Record numbers, most wins first
+    ScoreRecord records[];
+} ScoreFile;
+
+// A consistent copy of one record, for readers
+typedef struct {
+    int table_id;
+    int seat;
+    uint64_t wins;
+    uint64_t rounds;
+    uint64_t points;
+} ScoreEntry;
+
+// Open (or create/grow) SCORES_FILE for table_count tables; master, before fork()
+int init_score_system(int table_count);
+// msync() and unmap it
+void shutdown_score_system(void);
+// Map a score file read-only (tools)
+int attach_score_file(const char *path);
+
+// Book one finished round for a seat
+void update_score(int table_id, int seat, bool won, int points);
+
+// O(1): one seat's totals; false if it never finished a round
+bool score_lookup(int table_id, int seat, ScoreEntry *out);
+// The top min(n, SCORES_TOP_N) seats by wins; returns how many were stored
+int score_top(ScoreEntry *out, int n);
+
+#endif
@@ -4,10 +4,47 @@
 #include "game_state.h"
 
 // Memory management functions
-GameState* setup_shared_memory();
-void cleanup_shared_memory(GameState *gs);
+TableDirectory* setup_shared_memory(int table_count);
+void cleanup_shared_memory(TableDirectory *dir);
+
+// A worker's slice of the directory: its scheduler times the turns of
+// these tables, and in reactor mode its event loop serves their players.
+// Any worker may seat a player at any table (claim_seat()).
+typedef struct {
+    TableDirectory *dir;
+    int worker_id;
+    int first;
+    int count;
+} TableRange;
+
+// Table routing
+GameState* get_table(TableDirectory *dir, int idx);
+void split_tables(TableDirectory *dir, int workers, TableRange *ranges);
+int claim_seat(TableDirectory *dir, GameState **table);
+void release_seat(GameState *gs, int seat);
+
+// Sequence lock over a table's game state (players, turn, round flags).
+// Writers bracket every multi-field change; seq also serializes writers,
+// whichever semaphore they hold, so sections must stay short and must not
+// nest. A lone aligned store (one flag) needs no bracket. Readers never
+// block a writer: they copy and retry if seq moved underneath them.
+void table_write_begin(GameState *gs);
+void table_write_end(GameState *gs);
+void table_snapshot(const GameState *gs, TableSnapshot *out);
+
+// Wakeups for processes waiting on a table
+void notify_turn(GameState *gs);    // current_turn changed (new turn deadline)
+void notify_table(GameState *gs);   // round, game_over or seating changed
+TableDirectory* table_directory(GameState *gs);
+
+// Next table queued for this worker's scheduler, or -1 if none
+int pop_table_event(TableDirectory *dir, int worker_id);
+
+// Optional per-process hook run after every notify (the reactor uses it
+// to learn about changes made by its scheduler thread)
+extern void (*table_notify_hook)(GameState *gs);
 
 // This is the declaration that fixes the "implicit declaration" error
-void init_game_state_struct(GameState *gs);
+void init_game_state_struct(GameState *gs, const ShoeConfig *shoe);
 
 #endif
\ No newline at end of file
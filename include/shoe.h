@@ -0,0 +1,137 @@
+#ifndef SHOE_H
+#define SHOE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "rng.h"
+
+// N-deck shoe with a cut card. Each shoe owns its PRNG stream, so tables
+// (and forked processes) never share shuffle state, and a fixed seed
+// replays the same shoes.
+//
+// A shoe holds two card buffers: the live one being dealt and a spare that
+// the background shuffler (shuffler.h) fills ahead of time. Moving on to a
+// fresh shoe is then an index flip; only if the spare is not ready yet
+// does the dealer shuffle it itself. Shoes are dealt in the order they are
+// shuffled either way, so the deal does not depend on who shuffled.
+//
+// Dealing is lock-free and safe across processes. cursor packs the shoe
+// generation (high 32 bits; its low bit picks the live buffer) with the
+// next index, so one fetch-add claims a card. A claim past the end moves
+// the shoe to the next generation. A buffer goes back to the shuffler only
+// after every card claimed from it has been read (taken[] reaches
+// size + 1, the +1 being the swap itself), so no card is dealt twice or
+// read while it is being reshuffled.
+
+#define DECK_SIZE 52
+#define MAX_DECKS 8
+#define SHOE_MAX_CARDS (DECK_SIZE * MAX_DECKS)
+#define DEFAULT_DECKS 1
+#define DEFAULT_PENETRATION 75   // Percent of the shoe dealt before the cut card
+
+#define SHOE_GEN(cursor) ((uint32_t)((cursor) >> 32))
+#define SHOE_IDX(cursor) ((uint32_t)(cursor))
+
+typedef struct {
+    int decks;
+    int penetration;
+    uint64_t seed;
+} ShoeConfig;
+
+// State of the spare buffer (the one the cursor's generation is not using)
+enum {
+    SPARE_EMPTY,     // Drained; waiting for a shuffle
+    SPARE_FILLING,   // Being shuffled (the filler owns rng meanwhile)
+    SPARE_READY,     // Shuffled; next to be dealt
+    SPARE_SWAPPING,  // One dealer is making it live
+    SPARE_DRAINING   // Old live buffer; claimed cards still being read
+};
+
+typedef struct {
+    Rng rng;
+    int size;       // decks * DECK_SIZE
+    int cut;        // A round starting past this index reshuffles first
+    _Atomic uint64_t cursor;
+    _Atomic uint32_t taken[2];        // Cards read from each buffer this generation
+    _Atomic int spare;
+    _Atomic uint32_t inline_fills;    // Swaps that had to shuffle the spare themselves
+    uint8_t cards[2][SHOE_MAX_CARDS];
+} Shoe;
+
+// Run when a shoe's spare is drained and needs a shuffle (the server
+// counts these for its shuffler); NULL when nothing refills in the background
+extern void (*shoe_spare_hook)(Shoe *shoe);
+
+// Unbiased Fisher-Yates shuffle of n cards
+void shuffle_cards(uint8_t *cards, int n, Rng *rng);
+
+// Seeds the shoe from (cfg->seed, stream), shuffles it and its spare
+void shoe_init(Shoe *shoe, const ShoeConfig *cfg, uint64_t stream);
+
+// Starts dealing from a fresh shoe (the cut card came out)
+void shoe_swap(Shoe *shoe);
+
+// Moves generation gen on to the next shoe; no-op if it already moved
+void shoe_advance(Shoe *shoe, uint32_t gen);
+
+// Shuffler side: fills the spare if it is empty. Safe to call from any
+// thread or process at any time; returns true if it shuffled.
+bool shoe_fill_spare(Shoe *shoe);
+
+// Slow path of a read: the last reader of a swapped-out buffer retires it
+void shoe_retire(Shoe *shoe, int buffer);
+
+static inline void shoe_put_back(Shoe *shoe, int buffer, uint32_t count) {
+    uint32_t prev = atomic_fetch_add_explicit(&shoe->taken[buffer], count, memory_order_acq_rel);
+    if (prev + count == (uint32_t)shoe->size + 1) shoe_retire(shoe, buffer);
+}
+
+// Next card (1-13); an exhausted shoe swaps in a fresh one first. If slot
+// is not NULL it gets the cursor value the card was claimed at.
+static inline int shoe_draw_slot(Shoe *shoe, uint64_t *slot) {
+    for (;;) {
+        uint64_t c = atomic_fetch_add_explicit(&shoe->cursor, 1, memory_order_acquire);
+        uint32_t gen = SHOE_GEN(c);
+        if (SHOE_IDX(c) < (uint32_t)shoe->size) {
+            int card = shoe->cards[gen & 1][SHOE_IDX(c)];
+            shoe_put_back(shoe, gen & 1, 1);
+            if (slot) *slot = c;
+            return card;
+        }
+        shoe_advance(shoe, gen);
+    }
+}
+
+static inline int shoe_draw(Shoe *shoe) {
+    return shoe_draw_slot(shoe, NULL);
+}
+
+// shoe_draw() for a shoe only one thread ever deals from (bjsim's): the
+// same bookkeeping with plain loads and stores instead of locked RMWs
+static inline int shoe_draw_owned(Shoe *shoe) {
+    uint64_t c = atomic_load_explicit(&shoe->cursor, memory_order_relaxed);
+    if (SHOE_IDX(c) >= (uint32_t)shoe->size) {
+        shoe_advance(shoe, SHOE_GEN(c));
+        c = atomic_load_explicit(&shoe->cursor, memory_order_relaxed);
+    }
+    atomic_store_explicit(&shoe->cursor, c + 1, memory_order_relaxed);
+
+    // Draws alone never reach size + 1, so this never retires the buffer
+    int b = SHOE_GEN(c) & 1;
+    uint32_t t = atomic_load_explicit(&shoe->taken[b], memory_order_relaxed);
+    atomic_store_explicit(&shoe->taken[b], t + 1, memory_order_relaxed);
+    return shoe->cards[b][SHOE_IDX(c)];
+}
+
+// Cards claimed from the live shoe so far
+static inline uint32_t shoe_dealt(const Shoe *shoe) {
+    return SHOE_IDX(atomic_load_explicit(&shoe->cursor, memory_order_relaxed));
+}
+
+// True once the cut card is out: time to reshuffle between rounds
+static inline bool shoe_past_cut(const Shoe *shoe) {
+    return shoe_dealt(shoe) > (uint32_t)shoe->cut;
+}
+
+#endif
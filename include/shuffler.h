@@ -0,0 +1,19 @@
+#ifndef SHUFFLER_H
+#define SHUFFLER_H
+
+#include "game_state.h"
+
+// Background shoe shuffler. One thread in the master process keeps the
+// spare shoe of every table shuffled, so dealers never shuffle on the
+// dealing path. A retired shoe bumps dir->spares_taken and wakes
+// dir->shuffler_wq; the shuffler then sweeps the tables. With no shoe
+// retired it sleeps without a timeout, so an idle server costs no CPU.
+
+// Start the thread (call once, after the tables are initialized and
+// before fork(): workers inherit the hook that counts swaps)
+int start_shuffler(TableDirectory *dir);
+
+// Stop and join the thread
+void stop_shuffler(void);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef SPECTATOR_H
+#define SPECTATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "game_state.h"
+
+// Read-only observers. A spectator connects to SPECTATOR_PORT and sends
+// "watch <table>"; from then on it receives the whole table as one text
+// frame (TABLE:, SEAT:..., RESULT:, END lines) whenever the table moves.
+// Each table version is rendered once, into the table's shared TableFrame,
+// and all watchers are sent those same bytes. A watcher that cannot keep
+// up is never queued a backlog: it skips straight to the newest frame.
+
+#define SPECTATOR_PORT 8889
+#define SPECTATE_TICK_MS 50      // Longest a change waits to reach watchers
+#define SPECTATE_HELLO_MS 5000   // Time allowed to send the watch line
+
+// Copies the frame for the table's current version into out
+// (TABLE_FRAME_MAX bytes), rendering it first if nobody has yet.
+// Returns its length; *version is the state_version it shows.
+size_t spectator_frame(GameState *gs, char *out, uint32_t *version);
+
+// "watch <table>" -> table id, or -1
+int spectator_parse(const char *line, int table_count);
+
+// Fork mode: serves one spectator connection until it goes away
+void handle_spectator(int sock, TableDirectory *dir);
+
+// Reactor mode: every watcher of one worker, on one epoll instance of
+// its own that the reactor polls as a single fd
+typedef struct SpectatorHub SpectatorHub;
+
+// listen_sock -1: the spectator port is unavailable, nobody can watch
+SpectatorHub* spectator_hub_create(int listen_sock, TableDirectory *dir);
+int spectator_hub_fd(SpectatorHub *hub);
+// Accepts watchers and handles their socket events (call when the fd is readable)
+void spectator_hub_dispatch(SpectatorHub *hub);
+// Sends newer frames to watchers once per SPECTATE_TICK_MS; returns ms
+// until the next tick, or -1 with nobody watching
+int spectator_hub_tick(SpectatorHub *hub);
+void spectator_hub_destroy(SpectatorHub *hub);
+
+#endif
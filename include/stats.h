@@ -0,0 +1,78 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+// Latency histograms and counters in their own shared memory object next
+// to /blackjack_shm. Every server process records into it with relaxed
+// atomic adds (no locks, no syscalls); bjstat maps it read-only.
+//
+// Histograms are HDR-style log-linear: values below 16 ns get one bucket
+// each, above that every power of two is split into 16 sub-buckets, so a
+// reported percentile is within 1/16 (6.25%) of the true value.
+
+#define STATS_SHM_NAME "/blackjack_stats"
+#define STATS_MAGIC 0x424a5354u     // "BJST"
+#define STATS_VERSION 1
+#define STATS_SUB_BITS 4
+#define STATS_SUB_BUCKETS (1 << STATS_SUB_BITS)
+#define STATS_BUCKETS ((64 - STATS_SUB_BITS + 1) * STATS_SUB_BUCKETS)
+
+typedef enum {
+    STAT_FIRST_STATE,    // Connection accepted -> first STATE sent
+    STAT_ACTION_STATE,   // hit/stand received -> STATE sent back
+    STAT_TURN_HANDOFF,   // Turn passed -> that seat prompted
+    STAT_SHOE_SWAP,      // Switching shoes at the cut (inline shuffle if no spare)
+    STAT_ROUND,          // Cards dealt -> winner determined
+    STAT_COUNT
+} StatId;
+
+typedef enum {
+    CTR_ACCEPTED,
+    CTR_REFUSED,         // All tables full
+    CTR_DISCONNECTED,
+    CTR_ACTIONS,         // hit/stand commands played
+    CTR_COUNT
+} CounterId;
+
+typedef struct {
+    _Atomic uint64_t count;
+    _Atomic uint64_t sum;           // ns
+    _Atomic uint64_t max;           // ns
+    _Atomic uint64_t buckets[STATS_BUCKETS];
+} StatsHistogram;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int32_t server_pid;
+    int64_t started;                // time() at init_stats()
+    _Atomic uint64_t counters[CTR_COUNT];
+    StatsHistogram hist[STAT_COUNT];
+} StatsRegion;
+
+// Map the region (call once in the master, before fork())
+int init_stats(void);
+// Unmap and unlink it (master only)
+void shutdown_stats(void);
+
+// Monotonic ns; comparable across processes
+uint64_t stats_now(void);
+
+// Record now - start_ns (nothing if start_ns is 0 or stats are off)
+void stats_since(StatId id, uint64_t start_ns);
+void stats_record(StatId id, uint64_t ns);
+void stats_count(CounterId id);
+
+// Current totals (0 if stats are off)
+uint64_t stats_counter(CounterId id);
+uint64_t stats_samples(StatId id);
+
+// Shared with bjstat
+const char* stats_name(StatId id);
+const char* stats_counter_name(CounterId id);
+int stats_bucket(uint64_t ns);
+uint64_t stats_bucket_high(int bucket);   // Highest value the bucket holds
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef STRATEGY_H
+#define STRATEGY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "game_state.h"
+
+// Basic strategy for this game (no dealer, highest total wins), solved for
+// a seats-play-in-order approximation at build time by strategy_gen and compiled in as a table, so a decision is
+// one load. It depends on the hand, the best total a seat that already
+// finished holds, and how many seats still have to play after this one.
+
+#define STRATEGY_SEATS MAX_PLAYERS     // Seats after this one: 0..MAX_PLAYERS-1
+#define STRATEGY_TARGETS 23            // Total to beat: none, then 0..21
+#define STRATEGY_HARD 22               // Hard total: 0..21
+
+// [seats after][to_beat + 1][has an ace][hard total], 1 = hit
+extern const uint8_t strategy_table[STRATEGY_SEATS][STRATEGY_TARGETS][2][STRATEGY_HARD];
+
+// to_beat is -1 while no seat has finished without busting
+static inline bool strategy_hit(int hard_total, int aces, int to_beat, int seats_after) {
+    if (hard_total >= STRATEGY_HARD) return false;
+    if (to_beat < -1) to_beat = -1;
+    if (to_beat > 21) to_beat = 21;
+    if (seats_after >= STRATEGY_SEATS) seats_after = STRATEGY_SEATS - 1;
+    return strategy_table[seats_after][to_beat + 1][aces > 0][hard_total];
+}
+
+// The same decision for 'seat' of a table mid-round: seats that stood or
+// busted have finished, connected seats holding cards still to act play
+// after it
+static inline bool strategy_seat_hits(const PlayerState *players, int count, int seat) {
+    int to_beat = -1, seats_after = 0;
+    for (int i = 0; i < count; i++) {
+        const PlayerState *p = &players[i];
+        if (i == seat || !p->connected || p->card_count == 0) continue;
+        if (p->hard_total > 21) continue;
+        if (p->standing) {
+            if (p->points > to_beat) to_beat = p->points;
+        } else {
+            seats_after++;
+        }
+    }
+    const PlayerState *me = &players[seat];
+    return strategy_hit(me->hard_total, me->aces, to_beat, seats_after);
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Hierarchical timing wheel with 1 ms ticks: 4 levels of 64 slots cover
+// 2^24 ms (~4.6 hours). Arm, cancel and per-tick work are O(1); empty
+// stretches of time are skipped using per-level occupancy bitmaps.
+#define TW_LEVELS 4
+#define TW_BITS 6
+#define TW_SLOTS (1 << TW_BITS)
+
+typedef struct TimerNode {
+    struct TimerNode *next;
+    struct TimerNode *prev;
+    uint64_t expires;   // Absolute deadline in ms
+    int level;
+    int slot;
+    bool armed;
+} TimerNode;
+
+typedef struct {
+    uint64_t now;                           // Next tick to process (ms)
+    TimerNode *slots[TW_LEVELS][TW_SLOTS];
+    uint64_t occupied[TW_LEVELS];           // Bit per non-empty slot
+    int count;
+} TimerWheel;
+
+// Called for each expired timer. It may re-arm the node it is given but
+// must not arm or cancel any other timer.
+typedef void (*TimerCallback)(TimerNode *node, void *ctx);
+
+// Monotonic clock in milliseconds
+uint64_t tw_now_ms(void);
+
+void tw_init(TimerWheel *tw, uint64_t now_ms);
+
+// (Re)arm node to fire at expires_ms; re-arming cancels the old deadline
+void tw_arm(TimerWheel *tw, TimerNode *node, uint64_t expires_ms);
+void tw_cancel(TimerWheel *tw, TimerNode *node);
+
+// Fire every timer due at or before now_ms
+void tw_advance(TimerWheel *tw, uint64_t now_ms, TimerCallback cb, void *ctx);
+
+// Milliseconds until the wheel next needs tw_advance(), or -1 when empty
+int tw_timeout_ms(TimerWheel *tw, uint64_t now_ms);
+
+#endif
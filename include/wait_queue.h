@@ -0,0 +1,34 @@
+#ifndef WAIT_QUEUE_H
+#define WAIT_QUEUE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+// Process-shared wait queue: a futex word that lives in shared memory.
+// Waiters sleep in the kernel (zero CPU) until a notifier bumps seq.
+typedef struct {
+    _Atomic uint32_t seq;
+    _Atomic uint32_t waiters;
+} WaitQueue;
+
+// Snapshot seq BEFORE checking the condition you are waiting for
+uint32_t wq_prepare(WaitQueue *wq);
+
+// Sleep until seq moves past 'seen' (timeout_ms < 0 waits forever).
+// Returns 0 when woken or already changed, -1 on timeout.
+int wq_wait(WaitQueue *wq, uint32_t seen, int timeout_ms);
+
+// Bump seq and wake every sleeper (no syscall when nobody is waiting)
+void wq_wake_all(WaitQueue *wq);
+
+// Block until 'cond' holds, re-checking after every wakeup of 'wq'
+#define WQ_WAIT_UNTIL(wq, cond)                      \
+    do {                                             \
+        for (;;) {                                   \
+            uint32_t seen_ = wq_prepare(wq);         \
+            if (cond) break;                         \
+            wq_wait((wq), seen_, -1);                \
+        }                                            \
+    } while (0)
+
+#endif
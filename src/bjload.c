@@ -0,0 +1,463 @@
+// src/bjload.c
+// Load generator: thousands of text-protocol bots on a few threads, each
+// thread driving its share of sockets from one epoll loop (network.c does
+// the connecting and receiving). Bots think for a configurable time, play
+// a strategy, vote to continue for --rounds rounds and then leave.
+// Reports connect latency, action-to-STATE latency and rounds/sec.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include "network.h"
+#include "timer_wheel.h"
+#include "rng.h"
+
+#define DEFAULT_BOTS 100
+#define DEFAULT_THREADS 2
+#define DEFAULT_ROUNDS 3
+#define DEFAULT_DURATION 60      // Seconds before giving up on stragglers
+#define MAX_EVENTS 256
+#define BOT_LINE_MAX 2048
+#define ACTION_PROMPT "Your action: "
+#define ACTION_PROMPT_LEN (sizeof(ACTION_PROMPT) - 1)
+
+// --- 1. STRATEGIES ---
+
+typedef enum { STRAT_STAND, STRAT_NEVER, STRAT_RANDOM } StrategyKind;
+
+typedef struct {
+    const char *name;
+    StrategyKind kind;
+    int arg;
+} Strategy;
+
+// "stand:N" (hit below N), "never" or "random" (coin flip below 21)
+static bool parse_strategy(const char *spec, Strategy *out) {
+    if (strncmp(spec, "stand", 5) == 0 && (spec[5] == '\0' || spec[5] == ':')) {
+        *out = (Strategy){ "stand", STRAT_STAND, spec[5] == ':' ? atoi(spec + 6) : 17 };
+    } else if (strcmp(spec, "never") == 0) {
+        *out = (Strategy){ "never", STRAT_NEVER, 0 };
+    } else if (strcmp(spec, "random") == 0) {
+        *out = (Strategy){ "random", STRAT_RANDOM, 0 };
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// --- 2. BOTS ---
+
+typedef enum {
+    BOT_CONNECTING,
+    BOT_PLAYING,
+    BOT_DONE
+} BotState;
+
+typedef struct {
+    int fd;
+    BotState state;
+    int points;              // From this bot's latest STATE line
+    int rounds;              // Rounds finished (each ends in a continue vote)
+    bool refused;            // Server had no free seat
+    const char *pending;     // Reply waiting for its think time, or NULL
+    uint64_t connect_start;  // ns
+    uint64_t action_sent;    // ns of a hit/stand awaiting its STATE, or 0
+    char in[BOT_LINE_MAX];   // Bytes not yet terminated by '\n'
+    size_t in_len;
+} Bot;
+
+typedef struct {
+    long long *v;
+    long count, cap;
+} Samples;
+
+typedef struct {
+    const char *host;
+    int bots;
+    int threads;
+    int rounds;
+    int think_min, think_max;  // ms
+    int duration;              // s
+    int ramp;                  // New connections per second, 0 = all at once
+    Strategy strategy;
+    uint64_t seed;
+} LoadConfig;
+
+typedef struct {
+    const LoadConfig *cfg;
+    int id;
+    int count;                 // Bots owned by this thread
+    Bot *bots;
+    TimerNode *timers;         // Think timer per bot
+    TimerWheel wheel;
+    Rng rng;
+    int epfd;
+    int opened;                // Bots connected so far (see --ramp)
+    int live;
+
+    Samples connect_lat, action_lat;
+    long connected, refused, failed, rounds, unfinished;
+} LoadThread;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void add_sample(Samples *s, long long ns) {
+    if (s->count == s->cap) {
+        s->cap = s->cap ? s->cap * 2 : 1024;
+        long long *grown = realloc(s->v, sizeof(long long) * (size_t)s->cap);
+        if (!grown) return;
+        s->v = grown;
+    }
+    s->v[s->count++] = ns;
+}
+
+static void bot_finish(LoadThread *lt, Bot *b) {
+    if (b->state == BOT_DONE) return;
+    tw_cancel(&lt->wheel, &lt->timers[b - lt->bots]);
+    if (b->fd >= 0) {
+        epoll_ctl(lt->epfd, EPOLL_CTL_DEL, b->fd, NULL);
+        close_connection(b->fd);
+    }
+    b->fd = -1;
+    b->state = BOT_DONE;
+    lt->live--;
+}
+
+static void bot_send(Bot *b, const char *msg) {
+    if (strcmp(msg, "hit\n") == 0 || strcmp(msg, "stand\n") == 0) b->action_sent = now_ns();
+    send_message(b->fd, msg);
+}
+
+// Answers now, or after a think time drawn from [think_min, think_max]
+static void bot_reply(LoadThread *lt, Bot *b, const char *msg) {
+    const LoadConfig *cfg = lt->cfg;
+    int think = cfg->think_min;
+    if (cfg->think_max > cfg->think_min) {
+        think += (int)rng_below(&lt->rng, (uint32_t)(cfg->think_max - cfg->think_min + 1));
+    }
+    if (think == 0) {
+        bot_send(b, msg);
+        return;
+    }
+    b->pending = msg;
+    tw_arm(&lt->wheel, &lt->timers[b - lt->bots], tw_now_ms() + (uint64_t)think);
+}
+
+static const char* choose_action(LoadThread *lt, const Bot *b) {
+    const Strategy *s = &lt->cfg->strategy;
+    bool hit;
+    switch (s->kind) {
+    case STRAT_STAND:  hit = b->points < s->arg; break;
+    case STRAT_RANDOM: hit = b->points < 21 && (rng_next(&lt->rng) & 1); break;
+    default:           hit = false; break;
+    }
+    return hit ? "hit\n" : "stand\n";
+}
+
+static void bot_line(LoadThread *lt, Bot *b, const char *line) {
+    if (strncmp(line, "STATE: ", 7) == 0) {
+        // "STATE: Game Over" answers the last action of a round
+        const char *pts = strstr(line, "points=");
+        if (pts) b->points = atoi(pts + 7);
+        if (b->action_sent) {
+            add_sample(&lt->action_lat, (long long)(now_ns() - b->action_sent));
+            b->action_sent = 0;
+        }
+    } else if (strstr(line, "another round?")) {
+        b->action_sent = 0; // Everyone busted: no STATE came
+        b->rounds++;
+        lt->rounds++;
+        bot_reply(lt, b, b->rounds < lt->cfg->rounds ? "yes\n" : "no\n");
+    } else if (strstr(line, "All tables are full")) {
+        b->refused = true;
+        lt->refused++;
+    }
+}
+
+static void bot_readable(LoadThread *lt, Bot *b) {
+    char buf[4096];
+    for (;;) {
+        int n = receive_message(b->fd, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        if (n <= 0) {
+            if (b->rounds < lt->cfg->rounds && !b->refused) lt->unfinished++;
+            bot_finish(lt, b);
+            return;
+        }
+        if (b->in_len + (size_t)n > sizeof(b->in)) b->in_len = 0; // Runaway line
+        memcpy(b->in + b->in_len, buf, (size_t)n);
+        b->in_len += (size_t)n;
+
+        size_t start = 0;
+        for (;;) {
+            // The action prompt is the one line sent without a newline
+            if (b->in_len - start >= ACTION_PROMPT_LEN &&
+                memcmp(b->in + start, ACTION_PROMPT, ACTION_PROMPT_LEN) == 0) {
+                start += ACTION_PROMPT_LEN;
+                bot_reply(lt, b, choose_action(lt, b));
+                continue;
+            }
+            char *nl = memchr(b->in + start, '\n', b->in_len - start);
+            if (!nl) break;
+            *nl = '\0';
+            bot_line(lt, b, b->in + start);
+            start = (size_t)(nl - b->in) + 1;
+        }
+        memmove(b->in, b->in + start, b->in_len - start);
+        b->in_len -= start;
+    }
+}
+
+static void bot_writable(LoadThread *lt, Bot *b) {
+    if (connect_result(b->fd) != 0) {
+        lt->failed++;
+        bot_finish(lt, b);
+        return;
+    }
+    add_sample(&lt->connect_lat, (long long)(now_ns() - b->connect_start));
+    lt->connected++;
+    b->state = BOT_PLAYING;
+    struct epoll_event ev = { .events = EPOLLIN | EPOLLRDHUP, .data.ptr = b };
+    epoll_ctl(lt->epfd, EPOLL_CTL_MOD, b->fd, &ev);
+}
+
+// Timer wheel callback: a bot finished thinking
+static void on_think_done(TimerNode *node, void *arg) {
+    LoadThread *lt = arg;
+    Bot *b = &lt->bots[node - lt->timers];
+    if (b->state != BOT_PLAYING || !b->pending) return;
+    bot_send(b, b->pending);
+    b->pending = NULL;
+}
+
+// --- 3. THREADS ---
+
+static void bot_connect(LoadThread *lt, Bot *b) {
+    b->connect_start = now_ns();
+    b->fd = connect_to_server_async(lt->cfg->host);
+    if (b->fd < 0) {
+        lt->failed++;
+        b->state = BOT_DONE;
+        return;
+    }
+    b->state = BOT_CONNECTING;
+    struct epoll_event ev = { .events = EPOLLOUT, .data.ptr = b };
+    if (epoll_ctl(lt->epfd, EPOLL_CTL_ADD, b->fd, &ev) < 0) {
+        close_connection(b->fd);
+        lt->failed++;
+        b->state = BOT_DONE;
+        return;
+    }
+    lt->live++;
+}
+
+static void* load_thread(void *arg) {
+    LoadThread *lt = arg;
+    const LoadConfig *cfg = lt->cfg;
+    struct epoll_event events[MAX_EVENTS];
+
+    tw_init(&lt->wheel, tw_now_ms());
+    rng_seed(&lt->rng, cfg->seed, (uint64_t)lt->id);
+
+    uint64_t started = tw_now_ms();
+    uint64_t deadline = started + (uint64_t)cfg->duration * 1000;
+    while (lt->live > 0 || lt->opened < lt->count) {
+        uint64_t now = tw_now_ms();
+        if (now >= deadline) break;
+
+        // Open every bot due by now; this thread's share of --ramp
+        int due = lt->count;
+        if (cfg->ramp > 0) {
+            uint64_t ramped = (now - started) * (uint64_t)cfg->ramp / (1000ULL * (uint64_t)cfg->threads) + 1;
+            if (ramped < (uint64_t)due) due = (int)ramped;
+        }
+        while (lt->opened < due) bot_connect(lt, &lt->bots[lt->opened++]);
+
+        int timeout = tw_timeout_ms(&lt->wheel, now);
+        int left = (int)(deadline - now);
+        if (timeout < 0 || timeout > left) timeout = left;
+        if (lt->opened < lt->count) timeout = 1;
+
+        int n = epoll_wait(lt->epfd, events, MAX_EVENTS, timeout);
+        if (n < 0 && errno != EINTR) break;
+        for (int i = 0; i < n; i++) {
+            Bot *b = events[i].data.ptr;
+            if (b->state == BOT_CONNECTING) {
+                bot_writable(lt, b);
+            } else if (b->state == BOT_PLAYING) {
+                bot_readable(lt, b);
+            }
+        }
+        tw_advance(&lt->wheel, tw_now_ms(), on_think_done, lt);
+    }
+
+    // Whoever is left timed out (usually alone at a table)
+    for (int i = 0; i < lt->opened; i++) {
+        if (lt->bots[i].state != BOT_DONE) {
+            lt->unfinished++;
+            bot_finish(lt, &lt->bots[i]);
+        }
+    }
+    return NULL;
+}
+
+// --- 4. REPORT ---
+
+static int cmp_ll(const void *a, const void *b) {
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+static void merge(Samples *into, const Samples *from) {
+    for (long i = 0; i < from->count; i++) add_sample(into, from->v[i]);
+}
+
+static void print_latency(const char *label, Samples *s) {
+    if (s->count == 0) {
+        printf("%-16s no samples\n", label);
+        return;
+    }
+    qsort(s->v, (size_t)s->count, sizeof(long long), cmp_ll);
+    printf("%-16s p50 %lld us, p99 %lld us, p99.9 %lld us, max %lld us (%ld samples)\n", label,
+           s->v[s->count / 2] / 1000, s->v[(long)((double)s->count * 0.99)] / 1000,
+           s->v[(long)((double)s->count * 0.999)] / 1000, s->v[s->count - 1] / 1000, s->count);
+}
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s [--host IP] [--bots N] [--threads N] [--rounds N] [--think MS[-MS]]\n"
+           "          [--strategy stand:N|never|random] [--ramp N] [--duration S] [--seed N]\n", prog);
+    printf("  --host IP    Server address (default 127.0.0.1, port 8888)\n");
+    printf("  --bots N     Simultaneous connections (default %d)\n", DEFAULT_BOTS);
+    printf("  --threads N  Threads sharing the bots, one epoll loop each (default %d)\n",
+           DEFAULT_THREADS);
+    printf("  --rounds N   Rounds each bot plays before voting no (default %d)\n", DEFAULT_ROUNDS);
+    printf("  --think MS[-MS]\n");
+    printf("               Delay before each reply, fixed or uniform in a range (default 0)\n");
+    printf("  --strategy   stand:N hits below N (default stand:17), never always stands,\n");
+    printf("               random flips a coin below 21\n");
+    printf("  --ramp N     Open at most N connections per second (default: all at once)\n");
+    printf("  --duration S Stop waiting for bots after S seconds (default %d)\n", DEFAULT_DURATION);
+    printf("  --seed N     Seed for think times and the random strategy (default 1)\n");
+}
+
+int main(int argc, char *argv[]) {
+    LoadConfig cfg = {
+        .host = "127.0.0.1",
+        .bots = DEFAULT_BOTS,
+        .threads = DEFAULT_THREADS,
+        .rounds = DEFAULT_ROUNDS,
+        .duration = DEFAULT_DURATION,
+        .strategy = { "stand", STRAT_STAND, 17 },
+        .seed = 1,
+    };
+    const char *strategy_spec = "stand:17";
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--host") == 0 && i + 1 < argc) {
+            cfg.host = argv[++i];
+        } else if (strcmp(argv[i], "--bots") == 0 && i + 1 < argc) {
+            cfg.bots = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            cfg.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            cfg.rounds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--think") == 0 && i + 1 < argc) {
+            const char *spec = argv[++i];
+            const char *dash = strchr(spec, '-');
+            cfg.think_min = atoi(spec);
+            cfg.think_max = dash ? atoi(dash + 1) : cfg.think_min;
+        } else if (strcmp(argv[i], "--strategy") == 0 && i + 1 < argc) {
+            strategy_spec = argv[++i];
+            if (!parse_strategy(strategy_spec, &cfg.strategy)) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--ramp") == 0 && i + 1 < argc) {
+            cfg.ramp = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            cfg.duration = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            cfg.seed = strtoull(argv[++i], NULL, 10);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (cfg.bots < 1 || cfg.threads < 1 || cfg.rounds < 1 || cfg.duration < 1 ||
+        cfg.ramp < 0 || cfg.think_min < 0 || cfg.think_max < cfg.think_min) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (cfg.threads > cfg.bots) cfg.threads = cfg.bots;
+
+    // A bot whose server already closed must not kill the whole run
+    signal(SIGPIPE, SIG_IGN);
+
+    Bot *bots = calloc((size_t)cfg.bots, sizeof(Bot));
+    TimerNode *timers = calloc((size_t)cfg.bots, sizeof(TimerNode));
+    LoadThread *lts = calloc((size_t)cfg.threads, sizeof(LoadThread));
+    pthread_t *tids = calloc((size_t)cfg.threads, sizeof(pthread_t));
+    if (!bots || !timers || !lts || !tids) {
+        perror("calloc");
+        return 1;
+    }
+
+    printf("bjload: %d bots on %d threads against %s, strategy %s, think %d-%d ms, %d rounds each\n",
+           cfg.bots, cfg.threads, cfg.host, strategy_spec, cfg.think_min, cfg.think_max, cfg.rounds);
+
+    uint64_t start = now_ns();
+    int first = 0;
+    for (int t = 0; t < cfg.threads; t++) {
+        LoadThread *lt = &lts[t];
+        lt->cfg = &cfg;
+        lt->id = t;
+        lt->count = cfg.bots / cfg.threads + (t < cfg.bots % cfg.threads);
+        lt->bots = bots + first;
+        lt->timers = timers + first;
+        first += lt->count;
+        lt->epfd = epoll_create1(EPOLL_CLOEXEC);
+        if (lt->epfd < 0 || pthread_create(&tids[t], NULL, load_thread, lt) != 0) {
+            perror("[ERROR] Failed to start load thread");
+            return 1;
+        }
+    }
+
+    Samples connect_lat = { 0 }, action_lat = { 0 };
+    long connected = 0, refused = 0, failed = 0, rounds = 0, unfinished = 0;
+    for (int t = 0; t < cfg.threads; t++) {
+        pthread_join(tids[t], NULL);
+        close(lts[t].epfd);
+        merge(&connect_lat, &lts[t].connect_lat);
+        merge(&action_lat, &lts[t].action_lat);
+        connected += lts[t].connected;
+        refused += lts[t].refused;
+        failed += lts[t].failed;
+        rounds += lts[t].rounds;
+        unfinished += lts[t].unfinished;
+    }
+    double elapsed = (double)(now_ns() - start) / 1e9;
+
+    printf("Connected:       %ld of %d (%ld failed, %ld refused: tables full)\n",
+           connected, cfg.bots, failed, refused);
+    print_latency("Connect:", &connect_lat);
+    print_latency("Action->STATE:", &action_lat);
+    printf("Rounds:          %ld bot-rounds in %.2f s, %.1f/s\n", rounds, elapsed,
+           elapsed > 0 ? (double)rounds / elapsed : 0.0);
+    if (unfinished > 0) {
+        printf("Unfinished:      %ld bots stopped before %d rounds (e.g. alone at a table)\n",
+               unfinished, cfg.rounds);
+    }
+    return (failed > 0 || connected == 0) ? 1 : 0;
+}
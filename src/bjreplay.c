@@ -0,0 +1,434 @@
+// src/bjreplay.c
+// Re-drives a traffic capture (server --capture FILE) against a running
+// server: one socket per captured connection, opened and fed at the
+// captured times scaled by --speed, or as fast as the server answers
+// with --speed max. Start the server with the seed the capture reports
+// so it deals the same shoes.
+//
+// The text protocol reads one command per prompt, so an input is only
+// sent once the server has repeated the prompt it answered in the
+// capture (the tail of the last server record before it), or has been
+// quiet for --settle ms (a "gate timeout": the server said something
+// different this time).
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "capture.h"
+
+#define REPLAY_PORT 8888
+#define DEFAULT_SETTLE_MS 1500
+#define POLL_MS 1
+#define PROMPT_MAX 16        // Bytes of the captured prompt to wait for
+#define SEEN_MAX 4096        // Server bytes kept since the last input
+
+// --- 1. LOADING ---
+
+typedef struct {
+    uint64_t t_us;
+    uint8_t kind;
+    uint16_t len;
+    const uint8_t *data;
+    const uint8_t *prompt;   // What the server said last before this event
+    uint16_t prompt_len;     // 0 = nothing since the previous input
+} Event;
+
+typedef struct {
+    uint32_t id;
+    Event *events;           // OPEN, IN and CLOSE in capture order
+    int count, cap;
+    uint64_t out_total;      // Captured server bytes, all told
+    const uint8_t *prompt;   // Tail of the latest captured server record
+    uint16_t prompt_len;
+
+    // Replay state
+    int next;
+    int fd;
+    bool done;
+    uint64_t rx;
+    uint8_t seen[SEEN_MAX];  // Server bytes since our last input
+    size_t seen_len;
+    long long last_io;       // Last byte sent or received (ns)
+    long long sent_at;       // Input awaiting its first reply byte, or 0
+} Conn;
+
+typedef struct {
+    CaptureHeader hdr;
+    uint8_t *raw;
+    Conn *conns;             // Indexed by connection id; id 0 unused
+    uint32_t conn_slots;
+    int conn_count;
+    long records;
+    uint64_t first_us, last_us;
+} Capture;
+
+static Conn* conn_get(Capture *cap, uint32_t id) {
+    if (id >= cap->conn_slots) {
+        uint32_t slots = cap->conn_slots ? cap->conn_slots : 64;
+        while (slots <= id) slots *= 2;
+        Conn *grown = realloc(cap->conns, sizeof(Conn) * slots);
+        if (!grown) return NULL;
+        memset(grown + cap->conn_slots, 0, sizeof(Conn) * (slots - cap->conn_slots));
+        cap->conns = grown;
+        cap->conn_slots = slots;
+    }
+    Conn *c = &cap->conns[id];
+    if (c->id == 0) {
+        c->id = id;
+        c->fd = -1;
+        cap->conn_count++;
+    }
+    return c;
+}
+
+static int load_capture(const char *path, Capture *cap, bool dump) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    rewind(f);
+    memset(cap, 0, sizeof(*cap));
+    cap->raw = malloc(size > 0 ? (size_t)size : 1);
+    if (!cap->raw || fread(cap->raw, 1, (size_t)size, f) != (size_t)size) {
+        fprintf(stderr, "%s: read failed\n", path);
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    if ((size_t)size < sizeof(CaptureHeader) ||
+        memcmp(cap->raw, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0) {
+        fprintf(stderr, "%s: not a capture file\n", path);
+        return -1;
+    }
+    memcpy(&cap->hdr, cap->raw, sizeof(CaptureHeader));
+    if (cap->hdr.version != CAPTURE_VERSION) {
+        fprintf(stderr, "%s: capture version %u, expected %u\n", path,
+                cap->hdr.version, CAPTURE_VERSION);
+        return -1;
+    }
+
+    static const char *kinds[] = { "?", "OPEN", "IN", "OUT", "CLOSE" };
+    size_t off = sizeof(CaptureHeader);
+    while (off + sizeof(CaptureRecord) <= (size_t)size) {
+        CaptureRecord rec;
+        memcpy(&rec, cap->raw + off, sizeof(rec));
+        off += sizeof(rec);
+        if (off + rec.len > (size_t)size) break; // Server died mid-write
+        const uint8_t *data = cap->raw + off;
+        off += rec.len;
+        if (rec.conn == 0 || rec.kind < CAP_OPEN || rec.kind > CAP_CLOSE) {
+            fprintf(stderr, "%s: bad record at offset %zu\n", path, off - rec.len - sizeof(rec));
+            return -1;
+        }
+
+        if (dump) {
+            printf("%10llu %5u %-5s %4u ", (unsigned long long)rec.t_us, rec.conn,
+                   kinds[rec.kind], rec.len);
+            for (int i = 0; i < rec.len && i < 60; i++) {
+                putchar(data[i] >= 0x20 && data[i] < 0x7F ? data[i] : '.');
+            }
+            putchar('\n');
+        }
+        if (cap->records++ == 0) cap->first_us = rec.t_us;
+        cap->last_us = rec.t_us;
+
+        Conn *c = conn_get(cap, rec.conn);
+        if (!c) return -1;
+        if (rec.kind == CAP_OUT) {
+            c->out_total += rec.len;
+            if (rec.len > 0) {
+                c->prompt_len = rec.len < PROMPT_MAX ? rec.len : PROMPT_MAX;
+                c->prompt = data + rec.len - c->prompt_len;
+            }
+            continue;
+        }
+        if (c->count == c->cap) {
+            c->cap = c->cap ? c->cap * 2 : 16;
+            Event *grown = realloc(c->events, sizeof(Event) * (size_t)c->cap);
+            if (!grown) return -1;
+            c->events = grown;
+        }
+        c->events[c->count++] = (Event){ rec.t_us, rec.kind, rec.len, data, c->prompt, c->prompt_len };
+        if (rec.kind == CAP_IN) c->prompt_len = 0;
+    }
+    if (off != (size_t)size) {
+        fprintf(stderr, "%s: ignoring %zu trailing bytes of a cut-off record\n",
+                path, (size_t)size - off);
+    }
+    return 0;
+}
+
+// --- 2. REPLAY ---
+
+typedef struct {
+    const char *host;
+    double speed;            // 0 = max
+    int settle_ms;
+} ReplayConfig;
+
+typedef struct {
+    long inputs, gate_timeouts, skipped, refused;
+    uint64_t rx, out_total;
+    long long *lat;          // Input to first reply byte, ns
+    long lat_count, lat_cap;
+} ReplayStats;
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int open_socket(const char *host) {
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(REPLAY_PORT) };
+    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) return -1;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void add_latency(ReplayStats *st, long long ns) {
+    if (st->lat_count == st->lat_cap) {
+        st->lat_cap = st->lat_cap ? st->lat_cap * 2 : 1024;
+        long long *grown = realloc(st->lat, sizeof(long long) * (size_t)st->lat_cap);
+        if (!grown) return;
+        st->lat = grown;
+    }
+    st->lat[st->lat_count++] = ns;
+}
+
+static void finish_conn(Conn *c, ReplayStats *st) {
+    for (int i = c->next; i < c->count; i++) st->skipped += c->events[i].kind == CAP_IN;
+    if (c->fd >= 0) close(c->fd);
+    c->fd = -1;
+    c->done = true;
+    st->rx += c->rx;
+}
+
+// Drains whatever the server sent; false once it closed the connection
+static bool drain_conn(Conn *c, ReplayStats *st, long long now) {
+    char buf[4096];
+    for (;;) {
+        ssize_t n = recv(c->fd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (n > 0) {
+            c->rx += (uint64_t)n;
+            if ((size_t)n >= SEEN_MAX) {
+                memcpy(c->seen, buf + n - SEEN_MAX, SEEN_MAX);
+                c->seen_len = SEEN_MAX;
+            } else {
+                if (c->seen_len + (size_t)n > SEEN_MAX) {
+                    size_t drop = c->seen_len + (size_t)n - SEEN_MAX;
+                    memmove(c->seen, c->seen + drop, c->seen_len - drop);
+                    c->seen_len -= drop;
+                }
+                memcpy(c->seen + c->seen_len, buf, (size_t)n);
+                c->seen_len += (size_t)n;
+            }
+            c->last_io = now;
+            if (c->sent_at) {
+                add_latency(st, now - c->sent_at);
+                c->sent_at = 0;
+            }
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+}
+
+/**
+ * Runs this connection's due events. An input (or the close) waits until
+ * its scaled time and until the server caught up with the capture.
+ */
+static void step_conn(Conn *c, const ReplayConfig *cfg, ReplayStats *st,
+                      long long start, uint64_t t0, long long now) {
+    while (!c->done && c->next < c->count) {
+        Event *ev = &c->events[c->next];
+        long long due = cfg->speed > 0 ? start + (long long)((double)(ev->t_us - t0) * 1000.0 / cfg->speed)
+                                       : start;
+        if (now < due) return;
+
+        if (ev->kind == CAP_OPEN) {
+            c->fd = open_socket(cfg->host);
+            if (c->fd < 0) {
+                st->refused++;
+                finish_conn(c, st);
+                return;
+            }
+            c->last_io = now;
+            c->next++;
+            continue;
+        }
+
+        if (ev->prompt_len > 0 && !memmem(c->seen, c->seen_len, ev->prompt, ev->prompt_len)) {
+            if (now - c->last_io < (long long)cfg->settle_ms * 1000000LL) return;
+            if (ev->kind == CAP_IN) st->gate_timeouts++;
+        }
+        if (ev->kind == CAP_CLOSE) {
+            c->next++;
+            finish_conn(c, st);
+            return;
+        }
+
+        size_t sent = 0;
+        while (sent < ev->len) {
+            ssize_t n = send(c->fd, ev->data + sent, ev->len - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            sent += (size_t)n;
+        }
+        c->next++;
+        if (sent < ev->len) {
+            finish_conn(c, st);
+            return;
+        }
+        st->inputs++;
+        c->seen_len = 0;
+        c->last_io = now;
+        c->sent_at = now;
+    }
+    if (!c->done && c->next == c->count) finish_conn(c, st); // Capture ended first
+}
+
+static int replay(Capture *cap, const ReplayConfig *cfg, ReplayStats *st) {
+    struct pollfd *pfds = malloc(sizeof(struct pollfd) * (size_t)cap->conn_count);
+    Conn **polled = malloc(sizeof(Conn *) * (size_t)cap->conn_count);
+    if (!pfds || !polled) return -1;
+
+    for (uint32_t id = 1; id < cap->conn_slots; id++) st->out_total += cap->conns[id].out_total;
+
+    long long start = now_ns();
+    int live = cap->conn_count;
+    while (live > 0) {
+        long long now = now_ns();
+        int n = 0;
+        live = 0;
+        for (uint32_t id = 1; id < cap->conn_slots; id++) {
+            Conn *c = &cap->conns[id];
+            if (c->id == 0 || c->done) continue;
+            step_conn(c, cfg, st, start, cap->first_us, now);
+            if (c->done) continue;
+            live++;
+            if (c->fd >= 0) {
+                pfds[n] = (struct pollfd){ .fd = c->fd, .events = POLLIN };
+                polled[n++] = c;
+            }
+        }
+        if (live == 0) break;
+
+        if (poll(pfds, (nfds_t)n, POLL_MS) < 0 && errno != EINTR) break;
+        now = now_ns();
+        for (int i = 0; i < n; i++) {
+            if (pfds[i].revents && !drain_conn(polled[i], st, now)) finish_conn(polled[i], st);
+        }
+    }
+    free(pfds);
+    free(polled);
+    return 0;
+}
+
+// --- 3. REPORT ---
+
+static int cmp_ll(const void *a, const void *b) {
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+static void print_report(const char *path, const Capture *cap, const ReplayConfig *cfg,
+                         const ReplayStats *st, double wall) {
+    double captured = (double)(cap->last_us - cap->first_us) / 1e6;
+    char speed[32];
+    if (cfg->speed > 0) snprintf(speed, sizeof(speed), "%gx", cfg->speed);
+    else snprintf(speed, sizeof(speed), "max");
+
+    printf("Replayed %s at %s speed\n", path, speed);
+    printf("Connections:    %d (%ld refused)\n", cap->conn_count, st->refused);
+    printf("Inputs sent:    %ld (%ld after a gate timeout, %ld skipped)\n",
+           st->inputs, st->gate_timeouts, st->skipped);
+    printf("Server output:  %llu bytes (captured %llu)\n",
+           (unsigned long long)st->rx, (unsigned long long)st->out_total);
+    printf("Wall time:      %.3f s (captured %.3f s), %.0f inputs/s\n",
+           wall, captured, wall > 0 ? (double)st->inputs / wall : 0.0);
+    if (st->lat_count > 0) {
+        printf("Reply latency:  p50 %lld us, p99 %lld us, max %lld us\n",
+               st->lat[st->lat_count / 2] / 1000,
+               st->lat[(long)((double)st->lat_count * 0.99)] / 1000,
+               st->lat[st->lat_count - 1] / 1000);
+    }
+}
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s FILE [--host IP] [--speed X|max] [--settle MS] [--dump]\n", prog);
+    printf("  --host IP    Server to replay against (default 127.0.0.1, port %d)\n", REPLAY_PORT);
+    printf("  --speed X    Scale captured timing: 1 = as captured, 10 = ten times faster,\n");
+    printf("               max = send each input as soon as the server has answered (default 1)\n");
+    printf("  --settle MS  How long a connection may stay quiet before its next input\n");
+    printf("               is sent anyway (default %d)\n", DEFAULT_SETTLE_MS);
+    printf("  --dump       Print the capture's records instead of replaying them\n");
+}
+
+int main(int argc, char *argv[]) {
+    ReplayConfig cfg = { "127.0.0.1", 1.0, DEFAULT_SETTLE_MS };
+    const char *path = NULL;
+    bool dump = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--host") == 0 && i + 1 < argc) {
+            cfg.host = argv[++i];
+        } else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            const char *s = argv[++i];
+            cfg.speed = strcmp(s, "max") == 0 ? 0.0 : atof(s);
+            if (strcmp(s, "max") != 0 && cfg.speed <= 0) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--settle") == 0 && i + 1 < argc) {
+            cfg.settle_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--dump") == 0) {
+            dump = true;
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!path || cfg.settle_ms < 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    Capture cap;
+    if (load_capture(path, &cap, dump) != 0) return 1;
+    printf("Capture: %ld records, %d connections; server ran with --decks %u --penetration %u --seed %llu\n",
+           cap.records, cap.conn_count, cap.hdr.decks, cap.hdr.penetration,
+           (unsigned long long)cap.hdr.seed);
+    if (dump || cap.conn_count == 0) return 0;
+
+    ReplayStats st;
+    memset(&st, 0, sizeof(st));
+    long long t0 = now_ns();
+    if (replay(&cap, &cfg, &st) != 0) return 1;
+    double wall = (double)(now_ns() - t0) / 1e9;
+
+    qsort(st.lat, (size_t)st.lat_count, sizeof(long long), cmp_ll);
+    print_report(path, &cap, &cfg, &st, wall);
+    return st.refused > 0 ? 1 : 0;
+}
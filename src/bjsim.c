@@ -0,0 +1,358 @@
+// src/bjsim.c
+// Headless Monte Carlo simulator: plays millions of rounds in-process on
+// every core with the server's own rules (rules.c), no sockets and no
+// shared memory.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "game_state.h"
+#include "rules.h"
+#include "shoe.h"
+#include "strategy.h"
+
+#define SIM_CHUNK 10000          // Rounds per work unit
+#define DEFAULT_ROUNDS 1000000
+#define DEFAULT_SEED 1
+
+// --- 1. PLAYER POLICIES ---
+
+/**
+ * A policy decides hit (true) or stand for 'seat' given the whole table.
+ * Seats act in order, so seats below 'seat' have already finished.
+ */
+typedef bool (*PolicyFn)(const PlayerState *table, int seats, int seat, int arg);
+
+typedef struct {
+    const char *name;
+    PolicyFn wants_hit;
+    int arg;
+} SimPolicy;
+
+// Hit while below a fixed total ("stand:17")
+static bool policy_stand_on(const PlayerState *table, int seats, int seat, int arg) {
+    (void)seats;
+    return table[seat].points < arg;
+}
+
+// Never draw past the first two cards
+static bool policy_never(const PlayerState *table, int seats, int seat, int arg) {
+    (void)table; (void)seats; (void)seat; (void)arg;
+    return false;
+}
+
+// Hit until beating everyone who already finished, else play stand:arg
+static bool policy_beat(const PlayerState *table, int seats, int seat, int arg) {
+    int best = -1;
+    (void)seats;
+    for (int i = 0; i < seat; i++) {
+        if (!hand_busted(&table[i]) && table[i].points > best) best = table[i].points;
+    }
+    if (best < 0) return table[seat].points < arg;
+    return table[seat].points <= best;
+}
+
+// The build-time basic strategy (strategy.h)
+static bool policy_basic(const PlayerState *table, int seats, int seat, int arg) {
+    (void)arg;
+    return strategy_seat_hits(table, seats, seat);
+}
+
+// "stand:N", "never", "beat[:N]" or "basic"
+static bool parse_policy(const char *spec, SimPolicy *out) {
+    const char *colon = strchr(spec, ':');
+    size_t name_len = colon ? (size_t)(colon - spec) : strlen(spec);
+    int arg = colon ? atoi(colon + 1) : 17;
+
+    if (name_len == 5 && strncmp(spec, "stand", 5) == 0) {
+        *out = (SimPolicy){ "stand", policy_stand_on, arg };
+    } else if (name_len == 5 && strncmp(spec, "never", 5) == 0) {
+        *out = (SimPolicy){ "never", policy_never, 0 };
+    } else if (name_len == 4 && strncmp(spec, "beat", 4) == 0) {
+        *out = (SimPolicy){ "beat", policy_beat, arg };
+    } else if (name_len == 5 && strncmp(spec, "basic", 5) == 0) {
+        *out = (SimPolicy){ "basic", policy_basic, 0 };
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// --- 2. ROUNDS ---
+
+typedef struct {
+    uint64_t rounds;
+    uint64_t cards_dealt;
+    uint64_t all_bust;
+    uint64_t wins[MAX_PLAYERS];
+    uint64_t busts[MAX_PLAYERS];
+    uint64_t naturals[MAX_PLAYERS];   // 21 on the first two cards
+    uint64_t winning_total[22];       // Winner's points, rounds with a non-bust winner
+} SimStats;
+
+typedef struct {
+    int seats;
+    const SimPolicy *policies;        // One per seat
+} SimConfig;
+
+// One round exactly as reset_game_round() + the turn loop play it
+static void play_round(const SimConfig *cfg, Shoe *shoe, SimStats *st) {
+    PlayerState table[MAX_PLAYERS];
+
+    if (shoe_past_cut(shoe)) {
+        shoe_swap(shoe);
+    }
+
+    for (int i = 0; i < cfg->seats; i++) {
+        PlayerState *p = &table[i];
+        reset_player_state(p);
+        p->connected = true;
+        add_card(p, shoe_draw_owned(shoe));
+        add_card(p, shoe_draw_owned(shoe));
+        if (hand_is_blackjack(p)) st->naturals[i]++;
+    }
+    st->cards_dealt += (uint64_t)cfg->seats * 2;
+
+    for (int i = 0; i < cfg->seats; i++) {
+        PlayerState *p = &table[i];
+        const SimPolicy *pol = &cfg->policies[i];
+        while (!p->standing && !hand_busted(p) && p->card_count < MAX_CARDS &&
+               pol->wants_hit(table, cfg->seats, i, pol->arg)) {
+            add_card(p, shoe_draw_owned(shoe));
+            st->cards_dealt++;
+        }
+        p->standing = true;
+        if (hand_busted(p)) st->busts[i]++;
+    }
+
+    int winner = pick_winner(table, cfg->seats);
+    st->rounds++;
+    st->wins[winner]++;
+    if (hand_busted(&table[winner])) {
+        st->all_bust++;
+    } else {
+        st->winning_total[table[winner].points]++;
+    }
+}
+
+// --- 3. PARALLEL DRIVER ---
+
+/**
+ * Work is cut into fixed chunks of SIM_CHUNK rounds. Chunk c always uses
+ * PRNG stream c of the seed and starts from a fresh shoe, and the counters
+ * are plain sums, so the totals do not depend on which thread ran which
+ * chunk: the same seed gives identical results for any --threads.
+ */
+typedef struct {
+    const SimConfig *cfg;
+    ShoeConfig shoe;                  // Decks, penetration and the seed
+    uint64_t rounds;
+    uint64_t chunks;
+    _Atomic uint64_t next_chunk;
+} SimJob;
+
+typedef struct {
+    SimJob *job;
+    SimStats stats;
+    pthread_t tid;
+} SimWorker;
+
+static void* sim_worker(void *arg) {
+    SimWorker *w = arg;
+    SimJob *job = w->job;
+    Shoe shoe;
+    SimStats stats;   // Local until the end: no false sharing between workers
+    memset(&stats, 0, sizeof(stats));
+
+    for (;;) {
+        uint64_t c = atomic_fetch_add(&job->next_chunk, 1);
+        if (c >= job->chunks) break;
+
+        uint64_t first = c * SIM_CHUNK;
+        uint64_t count = job->rounds - first < SIM_CHUNK ? job->rounds - first : SIM_CHUNK;
+
+        shoe_init(&shoe, &job->shoe, c);
+        for (uint64_t r = 0; r < count; r++) {
+            play_round(job->cfg, &shoe, &stats);
+        }
+    }
+    w->stats = stats;
+    return NULL;
+}
+
+static void merge_stats(SimStats *into, const SimStats *from) {
+    into->rounds += from->rounds;
+    into->cards_dealt += from->cards_dealt;
+    into->all_bust += from->all_bust;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        into->wins[i] += from->wins[i];
+        into->busts[i] += from->busts[i];
+        into->naturals[i] += from->naturals[i];
+    }
+    for (int t = 0; t < 22; t++) {
+        into->winning_total[t] += from->winning_total[t];
+    }
+}
+
+// FNV-1a over the counters: equal digests mean equal results
+static uint64_t stats_digest(const SimStats *st) {
+    const unsigned char *b = (const unsigned char *)st;
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < sizeof(*st); i++) {
+        h = (h ^ b[i]) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// --- 4. REPORT ---
+
+static double pct(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * (double)part / (double)whole : 0.0;
+}
+
+static void print_report(const SimConfig *cfg, const SimStats *st, int threads,
+                         const ShoeConfig *shoe, double secs) {
+    printf("[BJSIM] %llu rounds, %d seats, %d threads, seed %llu\n",
+           (unsigned long long)st->rounds, cfg->seats, threads, (unsigned long long)shoe->seed);
+    printf("[BJSIM] %d deck(s), %d%% penetration\n", shoe->decks, shoe->penetration);
+    printf("[BJSIM] %.3f s, %.0f rounds/sec, %.2f cards/round\n",
+           secs, secs > 0 ? (double)st->rounds / secs : 0.0,
+           st->rounds ? (double)st->cards_dealt / (double)st->rounds : 0.0);
+
+    printf("\n%-6s %-10s %8s %8s %8s\n", "Seat", "Policy", "Win%", "Bust%", "21 dealt%");
+    for (int i = 0; i < cfg->seats; i++) {
+        char name[24];
+        const SimPolicy *pol = &cfg->policies[i];
+        if (pol->wants_hit == policy_never || pol->wants_hit == policy_basic) {
+            snprintf(name, sizeof(name), "%s", pol->name);
+        } else {
+            snprintf(name, sizeof(name), "%s:%d", pol->name, pol->arg);
+        }
+        printf("%-6d %-10s %8.3f %8.3f %8.3f\n", i, name,
+               pct(st->wins[i], st->rounds), pct(st->busts[i], st->rounds),
+               pct(st->naturals[i], st->rounds));
+    }
+    printf("\nAll seats bust: %.3f%%\n", pct(st->all_bust, st->rounds));
+
+    printf("Winning totals:");
+    for (int t = 0; t < 22; t++) {
+        if (st->winning_total[t] == 0) continue;
+        printf(" %d=%.2f%%", t, pct(st->winning_total[t], st->rounds));
+    }
+    printf("\nDigest: %016llx\n", (unsigned long long)stats_digest(st));
+}
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s [--rounds N] [--threads N] [--seed N] [--players N] [--policy LIST]\n"
+           "          [--decks N] [--penetration P]\n", prog);
+    printf("  --rounds N    Rounds to simulate (default %d)\n", DEFAULT_ROUNDS);
+    printf("  --threads N   Worker threads, one per core by default\n");
+    printf("  --seed N      PRNG seed; same seed, same results (default %d)\n", DEFAULT_SEED);
+    printf("  --players N   Seats at the table, 2-%d (default 2)\n", MAX_PLAYERS);
+    printf("  --policy LIST Comma-separated seat policies, repeated across seats:\n");
+    printf("                stand:N (hit below N), never, beat[:N], basic (default stand:17)\n");
+    printf("  --decks N     Decks in the shoe, 1-%d (default %d)\n", MAX_DECKS, DEFAULT_DECKS);
+    printf("  --penetration P  Percent of the shoe dealt before reshuffling (default %d)\n",
+           DEFAULT_PENETRATION);
+}
+
+int main(int argc, char *argv[]) {
+    uint64_t rounds = DEFAULT_ROUNDS;
+    ShoeConfig shoe = { DEFAULT_DECKS, DEFAULT_PENETRATION, DEFAULT_SEED };
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int seats = 2;
+    const char *policy_list = "stand:17";
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            rounds = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            shoe.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--players") == 0 && i + 1 < argc) {
+            seats = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+            policy_list = argv[++i];
+        } else if (strcmp(argv[i], "--decks") == 0 && i + 1 < argc) {
+            shoe.decks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--penetration") == 0 && i + 1 < argc) {
+            shoe.penetration = atoi(argv[++i]);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (threads < 1) threads = 1;
+    if (seats < 2 || seats > MAX_PLAYERS) {
+        fprintf(stderr, "[ERROR] --players must be between 2 and %d\n", MAX_PLAYERS);
+        return 1;
+    }
+    if (shoe.decks < 1 || shoe.decks > MAX_DECKS) {
+        fprintf(stderr, "[ERROR] --decks must be between 1 and %d\n", MAX_DECKS);
+        return 1;
+    }
+    if (shoe.penetration < 10 || shoe.penetration > 100) {
+        fprintf(stderr, "[ERROR] --penetration must be between 10 and 100\n");
+        return 1;
+    }
+
+    // Parse the policy list, then repeat it across the seats
+    SimPolicy parsed[MAX_PLAYERS], policies[MAX_PLAYERS];
+    int parsed_count = 0;
+    char list[256];
+    snprintf(list, sizeof(list), "%s", policy_list);
+    for (char *save = NULL, *tok = strtok_r(list, ",", &save); tok && parsed_count < MAX_PLAYERS;
+         tok = strtok_r(NULL, ",", &save)) {
+        if (!parse_policy(tok, &parsed[parsed_count++])) {
+            fprintf(stderr, "[ERROR] Unknown policy '%s'\n", tok);
+            return 1;
+        }
+    }
+    if (parsed_count == 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    for (int i = 0; i < seats; i++) {
+        policies[i] = parsed[i % parsed_count];
+    }
+
+    SimConfig cfg = { seats, policies };
+    SimJob job = { .cfg = &cfg, .shoe = shoe, .rounds = rounds,
+                   .chunks = (rounds + SIM_CHUNK - 1) / SIM_CHUNK };
+    atomic_init(&job.next_chunk, 0);
+
+    SimWorker *workers = calloc((size_t)threads, sizeof(SimWorker));
+    if (!workers) {
+        perror("[ERROR] calloc");
+        return 1;
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < threads; i++) {
+        workers[i].job = &job;
+        if (pthread_create(&workers[i].tid, NULL, sim_worker, &workers[i]) != 0) {
+            perror("[ERROR] pthread_create");
+            return 1;
+        }
+    }
+
+    SimStats total;
+    memset(&total, 0, sizeof(total));
+    for (int i = 0; i < threads; i++) {
+        pthread_join(workers[i].tid, NULL);
+        merge_stats(&total, &workers[i].stats);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double secs = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    print_report(&cfg, &total, threads, &shoe, secs);
+    free(workers);
+    return 0;
+}
@@ -0,0 +1,211 @@
+// src/bjstat.c
+// Prints the server's live latency percentiles and counters from the
+// /blackjack_stats segment (see stats.h). It maps the segment read-only
+// and only ever loads from it, so watching a busy server costs it nothing.
+// With --watch, every interval shows what happened during that interval.
+// --scores prints the leaderboard from the server's score file instead.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <signal.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "stats.h"
+#include "scores.h"
+
+static const double quantiles[] = { 0.50, 0.90, 0.99, 0.999 };
+#define QUANTILES (sizeof(quantiles) / sizeof(quantiles[0]))
+
+// A plain copy of the region, so interval deltas are simple subtractions
+typedef struct {
+    uint64_t counters[CTR_COUNT];
+    struct {
+        uint64_t count, sum, max;
+        uint64_t buckets[STATS_BUCKETS];
+    } hist[STAT_COUNT];
+} Snapshot;
+
+static volatile sig_atomic_t stop = 0;
+
+static void handle_signal(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+static void take_snapshot(const StatsRegion *region, Snapshot *snap) {
+    for (int c = 0; c < CTR_COUNT; c++) {
+        snap->counters[c] = atomic_load_explicit(&region->counters[c], memory_order_relaxed);
+    }
+    for (int h = 0; h < STAT_COUNT; h++) {
+        const StatsHistogram *src = &region->hist[h];
+        // count first: the buckets hold at least that many samples
+        snap->hist[h].count = atomic_load_explicit(&src->count, memory_order_acquire);
+        snap->hist[h].sum = atomic_load_explicit(&src->sum, memory_order_relaxed);
+        snap->hist[h].max = atomic_load_explicit(&src->max, memory_order_relaxed);
+        for (int b = 0; b < STATS_BUCKETS; b++) {
+            snap->hist[h].buckets[b] = atomic_load_explicit(&src->buckets[b], memory_order_relaxed);
+        }
+    }
+}
+
+// cur -= prev, field by field; max stays the all-time max
+static void subtract_snapshot(Snapshot *cur, const Snapshot *prev) {
+    for (int c = 0; c < CTR_COUNT; c++) cur->counters[c] -= prev->counters[c];
+    for (int h = 0; h < STAT_COUNT; h++) {
+        cur->hist[h].count -= prev->hist[h].count;
+        cur->hist[h].sum -= prev->hist[h].sum;
+        for (int b = 0; b < STATS_BUCKETS; b++) cur->hist[h].buckets[b] -= prev->hist[h].buckets[b];
+    }
+}
+
+static void format_ns(char *buf, size_t size, uint64_t ns) {
+    if (ns < 10000ULL) {
+        snprintf(buf, size, "%lluns", (unsigned long long)ns);
+    } else if (ns < 10000000ULL) {
+        snprintf(buf, size, "%.1fus", (double)ns / 1e3);
+    } else if (ns < 10000000000ULL) {
+        snprintf(buf, size, "%.1fms", (double)ns / 1e6);
+    } else {
+        snprintf(buf, size, "%.2fs", (double)ns / 1e9);
+    }
+}
+
+// Upper bound of the bucket holding the q-th sample, never above max
+static uint64_t percentile(const uint64_t *buckets, uint64_t count, uint64_t max, double q) {
+    uint64_t rank = (uint64_t)((double)count * q);
+    if (rank >= count) rank = count - 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < STATS_BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen > rank) {
+            uint64_t high = stats_bucket_high(b);
+            return high < max ? high : max;
+        }
+    }
+    return max;
+}
+
+static void print_snapshot(const Snapshot *snap, const char *title) {
+    printf("%s\n", title);
+    printf("  ");
+    for (int c = 0; c < CTR_COUNT; c++) {
+        printf("%s%s %llu", c ? ", " : "", stats_counter_name((CounterId)c),
+               (unsigned long long)snap->counters[c]);
+    }
+    printf("\n");
+
+    printf("  %-22s %9s %9s %9s %9s %9s %9s %9s\n",
+           "", "count", "mean", "p50", "p90", "p99", "p99.9", "max");
+    for (int h = 0; h < STAT_COUNT; h++) {
+        uint64_t count = snap->hist[h].count;
+        printf("  %-22s %9llu", stats_name((StatId)h), (unsigned long long)count);
+        if (count == 0) {
+            printf(" %9s %9s %9s %9s %9s %9s\n", "-", "-", "-", "-", "-", "-");
+            continue;
+        }
+        char buf[32];
+        format_ns(buf, sizeof(buf), snap->hist[h].sum / count);
+        printf(" %9s", buf);
+        for (size_t q = 0; q < QUANTILES; q++) {
+            format_ns(buf, sizeof(buf), percentile(snap->hist[h].buckets, count,
+                                                   snap->hist[h].max, quantiles[q]));
+            printf(" %9s", buf);
+        }
+        format_ns(buf, sizeof(buf), snap->hist[h].max);
+        printf(" %9s\n", buf);
+    }
+    fflush(stdout);
+}
+
+static int print_scores(const char *path) {
+    if (attach_score_file(path) != 0) return 1;
+
+    ScoreEntry top[SCORES_TOP_N];
+    int n = score_top(top, SCORES_TOP_N);
+    printf("Top %d of %s by wins\n", n, path);
+    printf("  %4s %6s %5s %9s %9s %8s %9s\n", "rank", "table", "seat", "wins", "rounds", "win %",
+           "avg hand");
+    for (int i = 0; i < n; i++) {
+        ScoreEntry *e = &top[i];
+        printf("  %4d %6d %5d %9llu %9llu %7.1f%% %9.1f\n", i + 1, e->table_id, e->seat,
+               (unsigned long long)e->wins, (unsigned long long)e->rounds,
+               e->rounds ? 100.0 * (double)e->wins / (double)e->rounds : 0.0,
+               e->rounds ? (double)e->points / (double)e->rounds : 0.0);
+    }
+    return 0;
+}
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s [--watch SEC] [--scores [FILE]]\n", prog);
+    printf("  --watch SEC  Print the last SEC seconds' numbers every SEC seconds until Ctrl+C\n");
+    printf("               (default: print totals since server start once)\n");
+    printf("  --scores     Print the leaderboard from FILE (default %s) and exit\n", SCORES_FILE);
+}
+
+int main(int argc, char *argv[]) {
+    int watch = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--watch") == 0 && i + 1 < argc) {
+            watch = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--scores") == 0) {
+            return print_scores(i + 1 < argc ? argv[i + 1] : SCORES_FILE);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    int fd = shm_open(STATS_SHM_NAME, O_RDONLY, 0);
+    if (fd == -1) {
+        fprintf(stderr, "bjstat: no stats segment (%s); is the server running?\n", STATS_SHM_NAME);
+        return 1;
+    }
+    const StatsRegion *region = mmap(NULL, sizeof(StatsRegion), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (region == MAP_FAILED) {
+        perror("bjstat: mmap");
+        return 1;
+    }
+    if (region->magic != STATS_MAGIC || region->version != STATS_VERSION) {
+        fprintf(stderr, "bjstat: %s has an unknown layout\n", STATS_SHM_NAME);
+        return 1;
+    }
+
+    Snapshot *cur = malloc(sizeof(Snapshot));
+    Snapshot *prev = malloc(sizeof(Snapshot));
+    if (!cur || !prev) return 1;
+
+    char title[128];
+    time_t started = (time_t)region->started;
+    take_snapshot(region, cur);
+    snprintf(title, sizeof(title), "Server pid %d, up %lds", region->server_pid,
+             (long)(time(NULL) - started));
+    print_snapshot(cur, title);
+
+    if (watch > 0) {
+        signal(SIGINT, handle_signal);
+        signal(SIGTERM, handle_signal);
+        while (!stop) {
+            Snapshot *tmp = prev;
+            prev = cur;
+            cur = tmp;
+            sleep((unsigned)watch);
+            if (stop) break;
+            take_snapshot(region, cur);
+            Snapshot delta = *cur;
+            subtract_snapshot(&delta, prev);
+            snprintf(title, sizeof(title), "\nLast %ds (up %lds)", watch,
+                     (long)(time(NULL) - started));
+            print_snapshot(&delta, title);
+        }
+    }
+
+    free(cur);
+    free(prev);
+    munmap((void *)region, sizeof(StatsRegion));
+    return 0;
+}
@@ -0,0 +1,138 @@
+// src/capture.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include "capture.h"
+
+_Static_assert(sizeof(CaptureHeader) == 24, "CaptureHeader must have no padding");
+_Static_assert(sizeof(CaptureRecord) == 16, "CaptureRecord must have no padding");
+
+// Shared by every process forked after capture_open()
+typedef struct {
+    _Atomic uint32_t next_conn;
+    uint64_t base_ns;
+} CaptureShared;
+
+static int cap_fd = -1;
+static CaptureShared *cap_shared = NULL;
+
+// Per-process map from socket to connection id (0 = not recorded)
+static uint32_t *conn_of_fd = NULL;
+static int conn_slots = 0;
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void write_record(uint32_t conn, CaptureKind kind, const void *data, size_t len) {
+    while (len > UINT16_MAX) {      // Never happens for game traffic; keeps len honest
+        write_record(conn, kind, data, UINT16_MAX);
+        data = (const char *)data + UINT16_MAX;
+        len -= UINT16_MAX;
+    }
+    CaptureRecord rec = {
+        .t_us = (mono_ns() - cap_shared->base_ns) / 1000,
+        .conn = conn,
+        .len = (uint16_t)len,
+        .kind = (uint8_t)kind,
+    };
+    struct iovec iov[2] = {
+        { &rec, sizeof(rec) },
+        { (void *)data, len },
+    };
+    // One append per record keeps records whole across processes
+    if (writev(cap_fd, iov, len > 0 ? 2 : 1) < 0) perror("[WARNING] capture write failed");
+}
+
+int capture_open(const char *path, const ShoeConfig *shoe) {
+    cap_shared = mmap(NULL, sizeof(CaptureShared), PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (cap_shared == MAP_FAILED) {
+        perror("[ERROR] capture mmap failed");
+        cap_shared = NULL;
+        return -1;
+    }
+    cap_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (cap_fd < 0) {
+        perror("[ERROR] Cannot open capture file");
+        munmap(cap_shared, sizeof(CaptureShared));
+        cap_shared = NULL;
+        return -1;
+    }
+
+    CaptureHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    hdr.version = CAPTURE_VERSION;
+    hdr.decks = (uint16_t)shoe->decks;
+    hdr.penetration = (uint16_t)shoe->penetration;
+    hdr.seed = shoe->seed;
+    if (write(cap_fd, &hdr, sizeof(hdr)) != (ssize_t)sizeof(hdr)) {
+        perror("[ERROR] capture header write failed");
+        capture_close();
+        return -1;
+    }
+    atomic_init(&cap_shared->next_conn, 1);
+    cap_shared->base_ns = mono_ns();
+    printf("[SYS] Capturing client traffic to %s\n", path);
+    return 0;
+}
+
+void capture_close(void) {
+    if (cap_fd >= 0) close(cap_fd);
+    if (cap_shared) munmap(cap_shared, sizeof(CaptureShared));
+    free(conn_of_fd);
+    cap_fd = -1;
+    cap_shared = NULL;
+    conn_of_fd = NULL;
+    conn_slots = 0;
+}
+
+void capture_conn_open(int fd) {
+    if (cap_fd < 0 || fd < 0) return;
+    if (fd >= conn_slots) {
+        int slots = conn_slots ? conn_slots : 64;
+        while (slots <= fd) slots *= 2;
+        uint32_t *grown = realloc(conn_of_fd, sizeof(uint32_t) * (size_t)slots);
+        if (!grown) return;       // Not recorded, game goes on
+        memset(grown + conn_slots, 0, sizeof(uint32_t) * (size_t)(slots - conn_slots));
+        conn_of_fd = grown;
+        conn_slots = slots;
+    }
+    conn_of_fd[fd] = atomic_fetch_add(&cap_shared->next_conn, 1);
+    write_record(conn_of_fd[fd], CAP_OPEN, NULL, 0);
+}
+
+static uint32_t conn_for(int fd) {
+    return (cap_fd >= 0 && fd >= 0 && fd < conn_slots) ? conn_of_fd[fd] : 0;
+}
+
+void capture_conn_close(int fd) {
+    uint32_t conn = conn_for(fd);
+    if (conn == 0) return;
+    write_record(conn, CAP_CLOSE, NULL, 0);
+    conn_of_fd[fd] = 0;
+}
+
+ssize_t capture_send(int fd, const void *buf, size_t len, int flags) {
+    ssize_t n = send(fd, buf, len, flags);
+    uint32_t conn = conn_for(fd);
+    if (n > 0 && conn) write_record(conn, CAP_OUT, buf, (size_t)n);
+    return n;
+}
+
+ssize_t capture_recv(int fd, void *buf, size_t len, int flags) {
+    ssize_t n = recv(fd, buf, len, flags);
+    uint32_t conn = conn_for(fd);
+    if (n > 0 && conn && !(flags & MSG_PEEK)) write_record(conn, CAP_IN, buf, (size_t)n);
+    return n;
+}
@@ -3,6 +3,112 @@
 #include <string.h>
 #include <unistd.h>
 #include <arpa/inet.h>
+#include "protocol.h"
+
+// Reads one line from the player, without the newline
+static void read_input(char *input, size_t size) {
+    memset(input, 0, size);
+    if (fgets(input, (int)size, stdin) == NULL) input[0] = '\0';
+    input[strcspn(input, "\n")] = 0;
+}
+
+/**
+ * Binary protocol session: frames are reassembled from however recv()
+ * split them, decoded in place, and printed as the same text a
+ * text-mode player would see.
+ */
+static void run_binary(int sock) {
+    uint8_t in[4096];
+    size_t in_len = 0;
+    uint8_t frame[PROTO_MAX_FRAME];
+    char text[PROTO_TEXT_MAX];
+    char input[1024];
+    bool negotiated = false;
+    ProtoState state;   // Last full STATE, kept current by DELTA frames
+    memset(&state, 0, sizeof(state));
+
+    send(sock, frame, proto_hello(frame), 0);
+
+    while (1) {
+        ssize_t valread = recv(sock, in + in_len, sizeof(in) - in_len, 0);
+        if (valread <= 0) {
+            printf("[CLIENT] Server disconnected or error occurred.\n");
+            return;
+        }
+        in_len += (size_t)valread;
+
+        // Refusals (all tables full) are sent before the hello is read
+        if (!negotiated && in[0] != 0) {
+            fwrite(in, 1, in_len, stdout);
+            in_len = 0;
+            continue;
+        }
+
+        size_t start = 0;
+        const ProtoHeader *hdr;
+        int len;
+        while ((len = proto_next_frame(in + start, in_len - start, &hdr)) > 0) {
+            start += (size_t)len;
+
+            if (hdr->type == MSG_HELLO_ACK) {
+                const ProtoHelloAck *ack = proto_payload(hdr);
+                printf("[CLIENT] Binary protocol v%d: table %d, seat %d.\n",
+                       ack->version, proto_get16(ack->table), ack->seat);
+                negotiated = true;
+                continue;
+            }
+
+            size_t n;
+            if (hdr->type == MSG_STATE) {
+                memcpy(&state, proto_payload(hdr), sizeof(state));
+                n = proto_state_text(&state, text, sizeof(text));
+            } else if (hdr->type == MSG_DELTA) {
+                if (!proto_apply_delta(&state, hdr)) {
+                    // Missed an update: ask for a full STATE
+                    send(sock, frame, proto_resync(frame), 0);
+                    continue;
+                }
+                n = proto_state_text(&state, text, sizeof(text));
+            } else {
+                n = proto_to_text(hdr, text, sizeof(text));
+            }
+            const ProtoRound *round = proto_payload(hdr);
+            if (hdr->type == MSG_ROUND && round->event == EV_YOUR_TURN) {
+                int bust = proto_get16(round->arg);
+                printf("MESSAGE: A hit busts %d.%d%% of the time.\n", bust / 10, bust % 10);
+            }
+            fwrite(text, 1, n, stdout);
+            if (hdr->type != MSG_ROUND) continue;
+
+            if (round->event == EV_YOUR_TURN) {
+                printf("> ");
+                fflush(stdout);
+                read_input(input, sizeof(input));
+                send(sock, frame, proto_action(frame, proto_parse_text(input)), 0);
+            } else if (round->event == EV_CONTINUE_VOTE) {
+                printf("> ");
+                fflush(stdout);
+                read_input(input, sizeof(input));
+                if (strcasecmp(input, "yes") != 0 && strcasecmp(input, "no") != 0) {
+                    printf("Please enter 'yes' or 'no': ");
+                    fflush(stdout);
+                    read_input(input, sizeof(input));
+                }
+                ProtoAction vote = strcasecmp(input, "yes") == 0 ? ACT_CONTINUE : ACT_LEAVE;
+                send(sock, frame, proto_action(frame, vote), 0);
+                if (vote == ACT_LEAVE) {
+                    printf("[CLIENT] Ending game session...\n");
+                }
+            }
+        }
+        if (len < 0) {
+            printf("[CLIENT] Malformed frame from server.\n");
+            return;
+        }
+        memmove(in, in + start, in_len - start);
+        in_len -= start;
+    }
+}
 
 int main(int argc, char *argv[]) {
     int sock = 0;
@@ -10,8 +116,8 @@ int main(int argc, char *argv[]) {
     char buffer[2048] = {0};
     char input[1024] = {0};
 
-    if (argc < 2) {
-        printf("Usage: ./client <IP_ADDRESS>\n");
+    if (argc < 2 || (argc > 2 && strcmp(argv[2], "--binary") != 0)) {
+        printf("Usage: ./client <IP_ADDRESS> [--binary]\n");
         return -1;
     }
 
@@ -35,6 +141,13 @@ int main(int argc, char *argv[]) {
 
     printf("[CLIENT] Connected to server.\n");
 
+    if (argc > 2) {
+        run_binary(sock);
+        close(sock);
+        printf("[CLIENT] Connection closed.\n");
+        return 0;
+    }
+
     // CONTINUOUS LOOP TO MATCH SERVER
     while (1) {
         memset(buffer, 0, sizeof(buffer));
@@ -1,63 +1,32 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <time.h>
 #include <unistd.h>
 #include <sys/socket.h>
+#include <poll.h>
 #include <semaphore.h>
 #include "game_state.h"
-
-// External declaration for the logger
-extern void log_event(const char* type, const char* details);
+#include "game_logic.h"
+#include "shared_mem.h"
+#include "logger.h"
+#include "protocol.h"
+#include "capture.h"
+#include "stats.h"
+#include "lock_profile.h"
+#include "scores.h"
+#include "network.h"
+#include "odds.h"
 
 // --- 1. HELPER LOGIC ---
 
-void shuffle_deck(int *deck, int size) {
-    for (int i = 0; i < size; i++) {
-        int j = rand() % size;
-        int temp = deck[i];
-        deck[i] = deck[j];
-        deck[j] = temp;
-    }
-}
-
-void init_deck(GameState *gs) {
-    int idx = 0;
-    for (int s = 0; s < 4; s++) {
-        for (int v = 1; v <= 13; v++) {
-            gs->deck[idx++] = v;
-        }
-    }
-    gs->deck_idx = 0;
-    shuffle_deck(gs->deck, DECK_SIZE);
-}
-
 /**
  * MEMBER 4: Thread-safe card drawing
- * Uses sem_wait and sem_post to prevent race conditions
+ * Lock-free: one atomic fetch-add on the shoe cursor claims the card
  */
 int draw_card(GameState *gs) {
-    sem_wait(&gs->deck_mutex); // --- LOCK ---
-
-    if (gs->deck_idx >= DECK_SIZE) {
-        init_deck(gs);
-    }
-    int card = gs->deck[gs->deck_idx++];
-
-    sem_post(&gs->deck_mutex); // --- UNLOCK ---
-    return card;
-}
-
-int calculate_points(const int *cards, int count) {
-    int points = 0, aces = 0;
-    for (int i = 0; i < count; i++) {
-        int val = cards[i];
-        if (val == 1) { aces++; points += 11; }
-        else if (val >= 10) { points += 10; }
-        else { points += val; }
-    }
-    while (points > 21 && aces > 0) { points -= 10; aces--; }
-    return points;
+    return shoe_draw(&gs->shoe);
 }
 
 const char* get_card_name(int val) {
@@ -70,74 +39,177 @@ const char* get_card_name(int val) {
     return buf;
 }
 
-void init_game_state_struct(GameState *gs) {
+void init_game_state_struct(GameState *gs, const ShoeConfig *shoe) {
     gs->current_turn = 0;
     gs->game_active = false;
     gs->game_over = false;
     gs->winner = -1;
     gs->round_number = 0;
-    srand(time(NULL));
-    init_deck(gs);
+    shoe_init(&gs->shoe, shoe, (uint64_t)gs->table_id);
 }
 
 // --- NEW FUNCTIONS FOR MULTIPLE ROUNDS ---
 
-void reset_player_state(PlayerState *p) {
-    p->card_count = 0;
-    p->points = 0;
-    p->standing = false;
-    memset(p->cards, 0, sizeof(p->cards));
-}
-
 void reset_game_round(GameState *gs) {
+    // Fresh shoe once the cut card has come out (pre-shuffled by the
+    // shuffler thread, so this is just a generation flip)
+    if (shoe_past_cut(&gs->shoe)) {
+        uint64_t swap_start = stats_now();
+        shoe_swap(&gs->shoe);
+        stats_since(STAT_SHOE_SWAP, swap_start);
+    }
+
+    // Readers see the old round or the new one dealt, never half of it
+    table_write_begin(gs);
+
     // Reset all players
-    for (int i = 0; i < gs->connected_count; i++) {
+    for (int i = 0; i < MAX_PLAYERS; i++) {
         if (gs->players[i].connected) {
             reset_player_state(&gs->players[i]);
         }
     }
     
-    // Reset game state
+    // Reset game state (first connected seat opens the round)
     gs->current_turn = 0;
+    while (gs->current_turn < MAX_PLAYERS - 1 && !gs->players[gs->current_turn].connected) {
+        gs->current_turn++;
+    }
     gs->game_over = false;
     gs->game_active = true;
     gs->winner = -1;
     gs->round_number++;
     
-    // Reinitialize deck if needed
-    if (gs->deck_idx > DECK_SIZE - 20) {  // Reshuffle if running low
-        init_deck(gs);
-    }
-    
     // Deal initial cards to connected players
-    for (int i = 0; i < gs->connected_count; i++) {
+    bool dealt[MAX_PLAYERS] = { false };
+    for (int i = 0; i < MAX_PLAYERS; i++) {
         if (gs->players[i].connected) {
             PlayerState *p = &gs->players[i];
-            p->cards[p->card_count++] = draw_card(gs);
-            p->cards[p->card_count++] = draw_card(gs);
-            p->points = calculate_points(p->cards, p->card_count);
+            add_card(p, draw_card(gs));
+            add_card(p, draw_card(gs));
             p->standing = false;
+            dealt[i] = true;
         }
     }
+    table_write_end(gs);
+
+    // Logging can block on a full ring: outside the write section
+    int dealt_in = 0;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (!dealt[i]) continue;
+        log_card_dealt(i, gs->players[i].cards[0]);
+        log_card_dealt(i, gs->players[i].cards[1]);
+        dealt_in++;
+    }
+    log_game_start(dealt_in);
+
+    // A new round is a turn handoff too: the first seat gets a fresh deadline
+    uint64_t now = stats_now();
+    atomic_store(&gs->round_started_ns, now);
+    atomic_store(&gs->turn_started_ns, now);
+    atomic_fetch_add(&gs->turn_seq, 1);
+    notify_table(gs);
 }
 
-bool ask_players_to_continue(GameState *gs, int sock, int my_id) {
-    char buffer[1024];
-    
+// Queues one frame, rendered as the text protocol unless the client said
+// hello. Nothing is sent until the handler is about to block (conn_flush).
+static void send_frame(Conn *conn, WireMode mode, const uint8_t *frame, size_t len) {
+    if (mode == WIRE_BINARY) {
+        conn_queue(conn, frame, len);
+        return;
+    }
+    char text[PROTO_TEXT_MAX];
+    size_t n = proto_to_text((const ProtoHeader *)frame, text, sizeof(text));
+    if (n > 0) conn_queue(conn, text, n);
+}
+
+static void send_round(Conn *conn, WireMode mode, RoundEvent event, int arg) {
+    uint8_t frame[PROTO_MAX_FRAME];
+    send_frame(conn, mode, frame, proto_round(frame, event, arg));
+}
+
+// Text clients always get the full STATE line; binary ones only what changed
+static void send_state(Conn *conn, WireMode mode, StateView *view, const TableSnapshot *snap, int id) {
+    uint8_t frame[PROTO_MAX_FRAME];
+    size_t len = mode == WIRE_BINARY ? proto_state_update(frame, view, snap, id)
+                                     : proto_state(frame, snap, id);
+    if (len > 0) send_frame(conn, mode, frame, len);
+}
+
+/**
+ * Waits up to PROTO_HELLO_WINDOW_MS for a binary hello. Text input that
+ * arrives instead stays buffered, so the first prompt still reads it.
+ * Returns -1 if the client sent something that is neither.
+ */
+static int negotiate_protocol(Conn *conn, GameState *gs, int id) {
+    struct pollfd pfd = { .fd = conn->fd, .events = POLLIN };
+
+    if (poll(&pfd, 1, PROTO_HELLO_WINDOW_MS) <= 0) return WIRE_TEXT;
+    if (conn_fill(conn) <= 0) return -1;
+
+    for (;;) {
+        size_t avail;
+        const uint8_t *in = (const uint8_t *)conn_data(conn, &avail);
+        if (in[0] != 0) return WIRE_TEXT;
+
+        const ProtoHeader *hello;
+        int len = proto_next_frame(in, avail, &hello);
+        if (len < 0 || (len > 0 && !proto_is_hello(hello))) return -1;
+        if (len > 0) {
+            conn_consume(conn, (size_t)len);
+            break;
+        }
+        if (conn_fill(conn) <= 0) return -1; // Rest of the hello still in flight
+    }
+
+    uint8_t frame[PROTO_MAX_FRAME];
+    conn_queue(conn, frame, proto_hello_ack(frame, id, gs->table_id));
+    return WIRE_BINARY;
+}
+
+/**
+ * Sends whatever is queued, then reads the player's next command; -1 once
+ * the client has gone. Commands typed ahead stay buffered for the next
+ * prompt instead of being lost with the rest of a recv().
+ */
+static int recv_action(Conn *conn, WireMode mode, StateView *view) {
+    conn_flush(conn);
+    for (;;) {
+        if (mode == WIRE_TEXT) {
+            char line[CONN_IN_MAX];
+            if (conn_line(conn, line, sizeof(line))) return proto_parse_text(line);
+        } else {
+            size_t avail;
+            const uint8_t *in = (const uint8_t *)conn_data(conn, &avail);
+            const ProtoHeader *hdr;
+            int len = proto_next_frame(in, avail, &hdr);
+            if (len < 0) return -1;
+            if (len > 0) {
+                int action = hdr->type == MSG_ACTION ? ((const ProtoActionMsg *)proto_payload(hdr))->action
+                                                     : -1;
+                if (hdr->type == MSG_RESYNC) view->valid = false; // Next update is a full STATE
+                conn_consume(conn, (size_t)len);
+                if (action >= 0) return action;
+                continue;
+            }
+        }
+
+        ssize_t n = conn_fill(conn);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+    }
+}
+
+bool ask_players_to_continue(GameState *gs, Conn *conn, int my_id, WireMode mode,
+                             StateView *view) {
     // Send continue prompt to this client
-    sprintf(buffer, "MESSAGE: Do you want to play another round? (yes/no)\n");
-    send(sock, buffer, strlen(buffer), 0);
+    send_round(conn, mode, EV_CONTINUE_VOTE, 0);
     
     // Receive response from this client
-    memset(buffer, 0, sizeof(buffer));
-    recv(sock, buffer, sizeof(buffer) - 1, 0);
-    
-    // Remove newline if present
-    buffer[strcspn(buffer, "\n")] = 0;
+    int action = recv_action(conn, mode, view);
     
     // Store the player's vote
     bool wants_to_continue = false;
-    if (strncasecmp(buffer, "yes", 3) == 0) {
+    if (action == ACT_CONTINUE) {
         gs->players[my_id].connected = true;  // Keep player connected
         wants_to_continue = true;
     } else {
@@ -149,55 +221,109 @@ bool ask_players_to_continue(GameState *gs, int sock, int my_id) {
 }
 
 void determine_winner(GameState *gs) {
-    int max_points = -1;
-    int winner = -1;
+    table_write_begin(gs);
+    int winner = pick_winner(gs->players, MAX_PLAYERS);
+    gs->winner = winner;
+    gs->game_over = true;
+    gs->game_active = false;
+    table_write_end(gs);
+    notify_table(gs);
+    log_game_end(winner);
 
+    // Several seats and the scheduler can settle the same round: whoever
+    // gets here first times it and books every seat's result
+    uint64_t started = atomic_exchange(&gs->round_started_ns, 0);
+    if (started == 0) return;
+    stats_since(STAT_ROUND, started);
     for (int i = 0; i < MAX_PLAYERS; i++) {
-        if (gs->players[i].connected && 
-            gs->players[i].points <= 21 && 
-            gs->players[i].points > max_points) {
-            max_points = gs->players[i].points;
-            winner = i;
+        PlayerState *p = &gs->players[i];
+        if (p->connected && p->card_count > 0) {
+            update_score(gs->table_id, i, i == winner, hand_busted(p) ? 0 : p->points);
         }
     }
-    
-    // Also check if all players busted
-    if (winner == -1) {
-        for (int i = 0; i < MAX_PLAYERS; i++) {
-            if (gs->players[i].connected) {
-                winner = i;  
-                break;
+}
+
+/**
+ * MEMBER 4: Dynamic turn switching
+ * Moves current_turn to the next connected seat (0 -> 1 -> 2 -> 0) and ends
+ * the round once every connected player is standing.
+ */
+void advance_turn(GameState *gs) {
+    TABLE_LOCK(gs, LOCK_TURN);
+    table_write_begin(gs);
+
+    // Skip players who are disconnected or not active
+    int next_player = gs->current_turn;
+    for (int attempts = 0; attempts < MAX_PLAYERS; attempts++) {
+        next_player = (next_player + 1) % MAX_PLAYERS;
+        if (gs->players[next_player].connected) break;
+    }
+    gs->current_turn = next_player;
+
+    // Check if ALL connected players are standing
+    bool all_standing = true;
+    int active_players = 0;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (gs->players[i].connected) {
+            active_players++;
+            if (!gs->players[i].standing) {
+                all_standing = false;
             }
         }
     }
 
-    gs->winner = winner;
-    gs->game_over = true;
-    gs->game_active = false;
-    
-    if (winner != -1) {
-        extern void update_score(int player_id, int score);
-        update_score(winner, 1);
+    if (all_standing && active_players > 0) {
+        gs->game_over = true;
+    }
+
+    table_write_end(gs);
+    TABLE_UNLOCK(gs, LOCK_TURN);
+
+    if (gs->game_over) {
+        notify_table(gs);
+    } else {
+        notify_turn(gs);
     }
 }
 
 // --- 2. MAIN CLIENT HANDLER (UPDATED FOR MULTIPLE ROUNDS) ---
 
-void handle_client(int sock, int id, GameState *gs) {
-    char buffer[1024], out_buf[2048], card_list[256];
+void handle_client(int sock, int id, GameState *gs, uint64_t accepted_ns) {
+    uint8_t frame[PROTO_MAX_FRAME];
+    StateView view = { .valid = false };
     PlayerState *p = &gs->players[id];
+    uint64_t action_ns = 0;         // Last hit/stand, until its STATE goes out
+    uint32_t prompted_seq = 0;      // turn_seq of the last YOUR_TURN prompt
+    
+    TableSnapshot snap;
+    ShoeCounts odds = { .synced = false };  // What is left in the table's shoe
+    Conn conn;
+    conn_init(&conn, sock, capture_send, capture_recv);
     
     // Initialize player
+    table_write_begin(gs);
     p->player_id = id;
     p->connected = true;
     p->active = true;
     reset_player_state(p);
+    table_write_end(gs);
+    capture_conn_open(sock);
     
-    // Wait for PvP start
-    send(sock, "MESSAGE: Waiting for Player 2 to join...\n", 42, 0);
-    while (gs->connected_count < 2) { 
-        usleep(100000); 
+    // Text or binary, decided by the client's first bytes
+    int negotiated = negotiate_protocol(&conn, gs, id);
+    if (negotiated < 0) {
+        release_seat(gs, id);
+        stats_count(CTR_DISCONNECTED);
+        capture_conn_close(sock);
+        close(sock);
+        return;
     }
+    WireMode mode = (WireMode)negotiated;
+
+    // Wait for PvP start
+    send_round(&conn, mode, EV_WAITING_PLAYERS, 0);
+    conn_flush(&conn);
+    WQ_WAIT_UNTIL(&gs->table_wq, gs->connected_count >= 2);
     
     // Set initial round number
     if (id == 0) {
@@ -205,9 +331,7 @@ void handle_client(int sock, int id, GameState *gs) {
         reset_game_round(gs);
     } else {
         // Wait for player 0 to initialize the game
-        while (gs->round_number == 0) {
-            usleep(100000);
-        }
+        WQ_WAIT_UNTIL(&gs->table_wq, gs->round_number != 0);
     }
     
     // MAIN GAME LOOP - Handles multiple rounds
@@ -215,146 +339,135 @@ void handle_client(int sock, int id, GameState *gs) {
     
     while (continue_playing && gs->players[id].connected) {
         // Send round info
-        sprintf(out_buf, "MESSAGE: Starting Round %d\n", gs->round_number);
-        send(sock, out_buf, strlen(out_buf), 0);
+        send_round(&conn, mode, EV_ROUND_START, gs->round_number);
         
         // Reset player state for this round
+        table_write_begin(gs);
         reset_player_state(p);
         
         // Deal initial cards if not already dealt
         if (p->card_count == 0) {
-            p->cards[p->card_count++] = draw_card(gs);
-            p->cards[p->card_count++] = draw_card(gs);
-            p->points = calculate_points(p->cards, p->card_count);
+            add_card(p, draw_card(gs));
+            add_card(p, draw_card(gs));
         }
+        table_write_end(gs);
         
         // GAME ROUND LOOP
         while (!gs->game_over && gs->players[id].connected) {
-            // Prepare Card List String
-            memset(card_list, 0, sizeof(card_list));
-            for(int i = 0; i < p->card_count; i++) {
-                char val[8];
-                sprintf(val, "%d%s", p->cards[i], (i == p->card_count-1 ? "" : ","));
-                strcat(card_list, val);
-            }
-
             // --- SEND THE STATE BLOCK ---
-            sprintf(out_buf, 
-                "STATE: turn=%d player_id=%d cards=%s points=%d standing=%s\n",
-                gs->current_turn, id, card_list, p->points, 
-                p->standing ? "true" : "false");
-            send(sock, out_buf, strlen(out_buf), 0);
-
-            if (gs->current_turn != id) {
-                sprintf(out_buf, "MESSAGE: Not Player %d's turn. Waiting...\n", id);
-                send(sock, out_buf, strlen(out_buf), 0);
-                while(gs->current_turn != id && !gs->game_over && gs->players[id].connected) { 
-                    usleep(200000); 
-                }
+            // One consistent copy drives both the STATE and the turn check
+            table_snapshot(gs, &snap);
+            send_state(&conn, mode, &view, &snap, id);
+            stats_since(STAT_FIRST_STATE, accepted_ns);
+            stats_since(STAT_ACTION_STATE, action_ns);
+            accepted_ns = action_ns = 0;
+
+            if (snap.game_over) continue;
+            if (snap.current_turn != id) {
+                send_round(&conn, mode, EV_NOT_YOUR_TURN, id);
+                conn_flush(&conn);
+                WQ_WAIT_UNTIL(&gs->seat_wq[id],
+                              gs->current_turn == id || gs->game_over || !gs->players[id].connected);
                 continue; 
             }
 
             // --- PLAYER ACTION ---
-            if (!p->standing && p->points <= 21) {
-                send(sock, "MESSAGE: Player's turn! hit or stand?\nYour action: ", 52, 0);
-                memset(buffer, 0, sizeof(buffer));
-                int bytes_received = recv(sock, buffer, 1024, 0);
-                if (bytes_received <= 0) {
+            if (!snap.players[id].standing && !hand_busted(&snap.players[id])) {
+                uint32_t seq = atomic_load(&gs->turn_seq);
+                if (seq != prompted_seq) {
+                    stats_since(STAT_TURN_HANDOFF, atomic_load(&gs->turn_started_ns));
+                    prompted_seq = seq;
+                }
+                odds_sync(&odds, &gs->shoe);
+                send_round(&conn, mode, EV_YOUR_TURN,
+                           odds_bust_permille(&odds, snap.players[id].hard_total));
+                int action = recv_action(&conn, mode, &view);
+                if (action < 0) {
                     gs->players[id].connected = false;
                     printf("[SERVER] Player %d disconnected.\n", id);
                     break;
                 }
 
-                // Remove newline
-                buffer[strcspn(buffer, "\n")] = 0;
-                
-                if (strncasecmp(buffer, "hit", 3) == 0) {
-                    p->cards[p->card_count++] = draw_card(gs);
-                    p->points = calculate_points(p->cards, p->card_count);
-                    if (p->points > 21) {
+                // The scheduler may have passed the turn on while we were
+                // blocked on the socket; a late action is dropped
+                TABLE_LOCK(gs, LOCK_TURN);
+                bool on_turn = gs->current_turn == id && !p->standing;
+                if (on_turn && (action == ACT_HIT || action == ACT_STAND)) {
+                    table_write_begin(gs);
+                    if (action == ACT_HIT) {
+                        add_card(p, draw_card(gs));
+                        // A bust or a full hand ends the turn
+                        if (hand_busted(p) || p->card_count == MAX_CARDS) {
+                            p->standing = true;
+                        }
+                    } else {
                         p->standing = true;
                     }
-                } else if (strncasecmp(buffer, "stand", 5) == 0) {
-                    p->standing = true;
+                    table_write_end(gs);
                 }
-            }
+                TABLE_UNLOCK(gs, LOCK_TURN);
+                if (!on_turn) continue;
 
-            // --- MEMBER 4: DYNAMIC TURN SWITCHING ---
-            sem_wait(&gs->turn_sem);
+                if (action == ACT_HIT || action == ACT_STAND) {
+                    action_ns = stats_now();
+                    stats_count(CTR_ACTIONS);
+                }
 
-            // Move to the next player (0 -> 1 -> 2 -> 0)
-            int next_player = (gs->current_turn + 1) % gs->connected_count;
-            
-            // Skip players who are disconnected or not active
-            int attempts = 0;
-            while (!gs->players[next_player].connected && attempts < gs->connected_count) {
-                next_player = (next_player + 1) % gs->connected_count;
-                attempts++;
-            }
-            
-            gs->current_turn = next_player;
-
-            // Check if ALL connected players are standing
-            bool all_standing = true;
-            int active_players = 0;
-            for (int i = 0; i < gs->connected_count; i++) {
-                if (gs->players[i].connected) {
-                    active_players++;
-                    if (!gs->players[i].standing) {
-                        all_standing = false;
-                    }
+                if (action == ACT_HIT) {
+                    log_card_dealt(id, p->cards[p->card_count - 1]);
+                    log_player_action(id, "hit", p->points);
+                } else if (action == ACT_STAND) {
+                    log_player_action(id, "stand", p->points);
                 }
             }
-            
-            if (all_standing && active_players > 0) {
-                gs->game_over = true;
-            }
 
-            sem_post(&gs->turn_sem);
+            // --- MEMBER 4: DYNAMIC TURN SWITCHING ---
+            advance_turn(gs);
         }
 
         // --- GAME OVER SUMMARY ---
+        action_ns = 0;      // The last action of a round gets no turn STATE
         if (gs->game_over && gs->players[id].connected) {
             // Ensure winner is determined (Scheduler might have done it, or we do it)
             if (gs->winner == -1 && gs->game_over) {
                 determine_winner(gs);
             }
             
-            int winner = gs->winner;
+            // Winner and their points from the same copy
+            table_snapshot(gs, &snap);
+            int winner = snap.winner;
             if (winner != -1) {
-                sprintf(out_buf, "STATE: Game Over\nMESSAGE: Winner is Player %d with %d points\n", 
-                        winner, gs->players[winner].points);
-                send(sock, out_buf, strlen(out_buf), 0);
+                send_frame(&conn, mode, frame,
+                           proto_result(frame, winner, snap.players[winner].points));
             }
             
             // Wait a moment before asking to continue
+            conn_flush(&conn);
             usleep(500000);
             
             // Ask if player wants to continue
-            bool wants_to_continue = ask_players_to_continue(gs, sock, id);
+            bool wants_to_continue = ask_players_to_continue(gs, &conn, id, mode, &view);
             
             if (!wants_to_continue) {
-                sprintf(out_buf, "MESSAGE: Player %d is leaving. Thanks for playing!\n", id);
-                send(sock, out_buf, strlen(out_buf), 0);
+                send_round(&conn, mode, EV_LEAVING, id);
                 continue_playing = false;
                 gs->players[id].connected = false;
             } else {
                 // Wait for all players to decide
-                sprintf(out_buf, "MESSAGE: Waiting for other players to decide...\n");
-                send(sock, out_buf, strlen(out_buf), 0);
+                send_round(&conn, mode, EV_WAITING_VOTES, 0);
                 
                 // Count how many players want to continue
                 int players_continuing = 0;
-                for (int i = 0; i < gs->connected_count; i++) {
+                for (int i = 0; i < MAX_PLAYERS; i++) {
                     if (gs->players[i].connected) players_continuing++;
                 }
                 
                 // Wait for all players to respond
+                conn_flush(&conn);
                 usleep(1000000);
                 
                 if (players_continuing < 2) {
-                    sprintf(out_buf, "MESSAGE: Not enough players to continue. Game ending.\n");
-                    send(sock, out_buf, strlen(out_buf), 0);
+                    send_round(&conn, mode, EV_GAME_ENDING, 0);
                     continue_playing = false;
                 } else {
                     // Reset for next round
@@ -364,13 +477,13 @@ void handle_client(int sock, int id, GameState *gs) {
                     if (id == 0) {
                         reset_game_round(gs);
                     } else {
-                        while (gs->game_over) {
-                            usleep(100000);
-                        }
+                        WQ_WAIT_UNTIL(&gs->table_wq, !gs->game_over);
                     }
                     
                     // Reset this player's state for new round
+                    table_write_begin(gs);
                     reset_player_state(p);
+                    table_write_end(gs);
                 }
             }
         }
@@ -381,18 +494,16 @@ void handle_client(int sock, int id, GameState *gs) {
         }
     }
     
-    // Player is leaving
-    gs->players[id].connected = false;
-    gs->players[id].active = false;
-    
-    // Decrease connected count
-    sem_wait(&gs->score_sem);
-    if (gs->connected_count > 0) {
-        gs->connected_count--;
-    }
-    sem_post(&gs->score_sem);
+    // Player is leaving: free the seat and decrease connected count
+    release_seat(gs, id);
     
-    printf("[SERVER] Player %d disconnected. Remaining players: %d\n", id, gs->connected_count);
+    printf("[SERVER] Table %d: Player %d disconnected. Remaining players: %d\n",
+           gs->table_id, id, gs->connected_count);
+    log_player_disconnect(id);
+    stats_count(CTR_DISCONNECTED);
     
+    conn_flush(&conn);
+    conn_free(&conn);
+    capture_conn_close(sock);
     close(sock);
 }
\ No newline at end of file
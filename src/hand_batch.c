@@ -0,0 +1,215 @@
+// src/hand_batch.c
+#include "hand_batch.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86 1
+#endif
+
+// A hand is scored as the sum of its cards with every ace worth 1, plus 10
+// if it holds an ace and that still fits under 21. That is the same total
+// calculate_points() reaches by counting aces as 11 and backing off, but it
+// needs no loop per hand, so it maps straight onto byte lanes.
+//
+// The winner reduction gives each seat a key: points + 1 if it is connected
+// and did not bust, 0 otherwise. The best key wins; walking the seats from
+// last to first and overwriting on a match leaves the lowest seat on a tie.
+
+// --- 1. SCALAR ---
+
+static void score_scalar(const uint8_t *const cards[MAX_CARDS], size_t from, size_t n,
+                         uint8_t *points) {
+    for (size_t h = from; h < n; h++) {
+        unsigned sum = 0, ace = 0;
+        for (int i = 0; i < MAX_CARDS; i++) {
+            unsigned c = cards[i][h];
+            sum += c < 10 ? c : 10;
+            ace |= (c == 1);
+        }
+        points[h] = (uint8_t)(sum + ((ace && sum <= 11) ? 10 : 0));
+    }
+}
+
+static void winners_scalar(const uint8_t *const points[MAX_PLAYERS],
+                           const uint8_t *const connected[MAX_PLAYERS],
+                           int seats, size_t from, size_t n, uint8_t *winner) {
+    for (size_t t = from; t < n; t++) {
+        unsigned best = 0;
+        uint8_t win = HAND_NO_WINNER, first = HAND_NO_WINNER;
+        for (int s = seats - 1; s >= 0; s--) {
+            unsigned key = (connected[s][t] && points[s][t] <= 21) ? points[s][t] + 1u : 0;
+            if (key >= best && key > 0) { best = key; win = (uint8_t)s; }
+            if (connected[s][t]) first = (uint8_t)s;
+        }
+        winner[t] = best ? win : first;
+    }
+}
+
+// --- 2. SSE2 (baseline on x86-64) ---
+
+#ifdef HAVE_X86
+__attribute__((target("sse2")))
+static void score_sse2(const uint8_t *const cards[MAX_CARDS], size_t n, uint8_t *points) {
+    const __m128i ten = _mm_set1_epi8(10), eleven = _mm_set1_epi8(11), one = _mm_set1_epi8(1);
+    size_t h = 0;
+
+    for (; h + 16 <= n; h += 16) {
+        __m128i sum = _mm_setzero_si128(), ace = _mm_setzero_si128();
+        for (int i = 0; i < MAX_CARDS; i++) {
+            __m128i c = _mm_loadu_si128((const __m128i *)(cards[i] + h));
+            sum = _mm_add_epi8(sum, _mm_min_epu8(c, ten));
+            ace = _mm_or_si128(ace, _mm_cmpeq_epi8(c, one));
+        }
+        __m128i fits = _mm_cmpeq_epi8(_mm_min_epu8(sum, eleven), sum);
+        __m128i bonus = _mm_and_si128(_mm_and_si128(ace, fits), ten);
+        _mm_storeu_si128((__m128i *)(points + h), _mm_add_epi8(sum, bonus));
+    }
+    score_scalar(cards, h, n, points);
+}
+
+// mask ? a : b, bytewise
+__attribute__((target("sse2")))
+static inline __m128i select_sse2(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+__attribute__((target("sse2")))
+static void winners_sse2(const uint8_t *const points[MAX_PLAYERS],
+                         const uint8_t *const connected[MAX_PLAYERS],
+                         int seats, size_t n, uint8_t *winner) {
+    const __m128i zero = _mm_setzero_si128(), one = _mm_set1_epi8(1);
+    const __m128i limit = _mm_set1_epi8(21), none = _mm_set1_epi8((char)HAND_NO_WINNER);
+    size_t t = 0;
+
+    for (; t + 16 <= n; t += 16) {
+        __m128i key[MAX_PLAYERS], conn[MAX_PLAYERS];
+        __m128i best = zero;
+        for (int s = 0; s < seats; s++) {
+            __m128i p = _mm_loadu_si128((const __m128i *)(points[s] + t));
+            __m128i c = _mm_loadu_si128((const __m128i *)(connected[s] + t));
+            conn[s] = _mm_xor_si128(_mm_cmpeq_epi8(c, zero), _mm_cmpeq_epi8(zero, zero));
+            __m128i live = _mm_and_si128(conn[s], _mm_cmpeq_epi8(_mm_min_epu8(p, limit), p));
+            key[s] = _mm_and_si128(live, _mm_add_epi8(p, one));
+            best = _mm_max_epu8(best, key[s]);
+        }
+        __m128i win = none, first = none;
+        for (int s = seats - 1; s >= 0; s--) {
+            __m128i seat = _mm_set1_epi8((char)s);
+            win = select_sse2(_mm_cmpeq_epi8(key[s], best), seat, win);
+            first = select_sse2(conn[s], seat, first);
+        }
+        __m128i busted = _mm_cmpeq_epi8(best, zero);
+        _mm_storeu_si128((__m128i *)(winner + t), select_sse2(busted, first, win));
+    }
+    winners_scalar(points, connected, seats, t, n, winner);
+}
+
+// --- 3. AVX2 ---
+
+__attribute__((target("avx2")))
+static void score_avx2(const uint8_t *const cards[MAX_CARDS], size_t n, uint8_t *points) {
+    const __m256i ten = _mm256_set1_epi8(10), eleven = _mm256_set1_epi8(11);
+    const __m256i one = _mm256_set1_epi8(1);
+    size_t h = 0;
+
+    for (; h + 32 <= n; h += 32) {
+        __m256i sum = _mm256_setzero_si256(), ace = _mm256_setzero_si256();
+        for (int i = 0; i < MAX_CARDS; i++) {
+            __m256i c = _mm256_loadu_si256((const __m256i *)(cards[i] + h));
+            sum = _mm256_add_epi8(sum, _mm256_min_epu8(c, ten));
+            ace = _mm256_or_si256(ace, _mm256_cmpeq_epi8(c, one));
+        }
+        __m256i fits = _mm256_cmpeq_epi8(_mm256_min_epu8(sum, eleven), sum);
+        __m256i bonus = _mm256_and_si256(_mm256_and_si256(ace, fits), ten);
+        _mm256_storeu_si256((__m256i *)(points + h), _mm256_add_epi8(sum, bonus));
+    }
+    score_scalar(cards, h, n, points);
+}
+
+__attribute__((target("avx2")))
+static void winners_avx2(const uint8_t *const points[MAX_PLAYERS],
+                         const uint8_t *const connected[MAX_PLAYERS],
+                         int seats, size_t n, uint8_t *winner) {
+    const __m256i zero = _mm256_setzero_si256(), one = _mm256_set1_epi8(1);
+    const __m256i limit = _mm256_set1_epi8(21), none = _mm256_set1_epi8((char)HAND_NO_WINNER);
+    size_t t = 0;
+
+    for (; t + 32 <= n; t += 32) {
+        __m256i key[MAX_PLAYERS], conn[MAX_PLAYERS];
+        __m256i best = zero;
+        for (int s = 0; s < seats; s++) {
+            __m256i p = _mm256_loadu_si256((const __m256i *)(points[s] + t));
+            __m256i c = _mm256_loadu_si256((const __m256i *)(connected[s] + t));
+            conn[s] = _mm256_xor_si256(_mm256_cmpeq_epi8(c, zero), _mm256_cmpeq_epi8(zero, zero));
+            __m256i live = _mm256_and_si256(conn[s], _mm256_cmpeq_epi8(_mm256_min_epu8(p, limit), p));
+            key[s] = _mm256_and_si256(live, _mm256_add_epi8(p, one));
+            best = _mm256_max_epu8(best, key[s]);
+        }
+        __m256i win = none, first = none;
+        for (int s = seats - 1; s >= 0; s--) {
+            __m256i seat = _mm256_set1_epi8((char)s);
+            win = _mm256_blendv_epi8(win, seat, _mm256_cmpeq_epi8(key[s], best));
+            first = _mm256_blendv_epi8(first, seat, conn[s]);
+        }
+        __m256i busted = _mm256_cmpeq_epi8(best, zero);
+        _mm256_storeu_si256((__m256i *)(winner + t), _mm256_blendv_epi8(win, first, busted));
+    }
+    winners_scalar(points, connected, seats, t, n, winner);
+}
+#endif
+
+// --- 4. DISPATCH ---
+
+static HandImpl active = HAND_IMPL_AUTO;
+
+static HandImpl best_supported(void) {
+#ifdef HAVE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return HAND_IMPL_AVX2;
+    if (__builtin_cpu_supports("sse2")) return HAND_IMPL_SSE2;
+#endif
+    return HAND_IMPL_SCALAR;
+}
+
+HandImpl hand_batch_use(HandImpl impl) {
+    HandImpl best = best_supported();
+    // Asking for more than the CPU has falls back to the best it does have
+    active = (impl == HAND_IMPL_AUTO || impl > best) ? best : impl;
+    return active;
+}
+
+const char* hand_impl_name(HandImpl impl) {
+    switch (impl) {
+    case HAND_IMPL_SCALAR: return "scalar";
+    case HAND_IMPL_SSE2:   return "sse2";
+    case HAND_IMPL_AVX2:   return "avx2";
+    default:               return "auto";
+    }
+}
+
+static HandImpl current(void) {
+    if (active == HAND_IMPL_AUTO) hand_batch_use(HAND_IMPL_AUTO);
+    return active;
+}
+
+void score_hands(const uint8_t *const cards[MAX_CARDS], size_t n, uint8_t *points) {
+    switch (current()) {
+#ifdef HAVE_X86
+    case HAND_IMPL_AVX2: score_avx2(cards, n, points); return;
+    case HAND_IMPL_SSE2: score_sse2(cards, n, points); return;
+#endif
+    default:             score_scalar(cards, 0, n, points); return;
+    }
+}
+
+void pick_winners(const uint8_t *const points[MAX_PLAYERS],
+                  const uint8_t *const connected[MAX_PLAYERS],
+                  int seats, size_t n, uint8_t *winner) {
+    switch (current()) {
+#ifdef HAVE_X86
+    case HAND_IMPL_AVX2: winners_avx2(points, connected, seats, n, winner); return;
+    case HAND_IMPL_SSE2: winners_sse2(points, connected, seats, n, winner); return;
+#endif
+    default:             winners_scalar(points, connected, seats, 0, n, winner); return;
+    }
+}
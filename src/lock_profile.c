@@ -0,0 +1,231 @@
+// src/lock_profile.c
+// Contention profiler behind TABLE_LOCK()/TABLE_UNLOCK(), compiled in only
+// with -DLOCK_PROFILE (see lock_profile.h).
+#include "lock_profile.h"
+
+#ifdef LOCK_PROFILE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "stats.h"
+
+// Flag thresholds for the report
+#define FLAG_PER_ACTION 1.5     // Taken this often per hit/stand: polling loop
+#define FLAG_CONTENDED 0.05     // Had to wait this often: contended
+#define FLAG_MIN_SAMPLES 100    // Too few acquisitions to call "never contended"
+
+typedef struct {
+    _Atomic uintptr_t key;      // The "file:line" literal; same address in every fork
+    const char *func;
+    LockKind kind;
+    _Atomic uint64_t acquired;
+    _Atomic uint64_t contended;
+    _Atomic uint64_t wait_ns;
+    _Atomic uint64_t wait_max;
+    _Atomic uint64_t hold_ns;
+    _Atomic uint64_t hold_max;
+} LockSite;
+
+// The semaphores are binary, so each (table, lock) has one holder at a time
+typedef struct {
+    uint64_t acquired_ns;
+    int site;
+} LockHold;
+
+typedef struct {
+    int table_count;
+    _Atomic uint64_t unprofiled;        // Acquisitions past LOCKPROF_SITES sites
+    LockSite sites[LOCKPROF_SITES];
+    LockHold holds[];                   // table_count * LOCK_KINDS
+} LockProfile;
+
+static LockProfile *profile = NULL;     // NULL: not initialized, plain sem ops
+static pid_t profile_owner = 0;
+static volatile sig_atomic_t report_requested = 0;
+
+static const char *lock_names[LOCK_KINDS] = { "turn_sem", "score_sem" };
+
+// The report uses stdio, so the handler only asks for it: lockprof_poll()
+// prints it from the master's main loop
+static void handle_report_signal(int sig) {
+    (void)sig;
+    report_requested = 1;
+}
+
+int lockprof_init(int table_count) {
+    size_t profile_size = sizeof(LockProfile) + (size_t)table_count * LOCK_KINDS * sizeof(LockHold);
+    LockProfile *p = mmap(NULL, profile_size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        perror("[ERROR] Lock profile mmap failed");
+        return -1;
+    }
+    p->table_count = table_count;
+    profile = p;
+    profile_owner = getpid();
+    // No SA_RESTART: the signal has to interrupt the master's wait()
+    struct sigaction sa = { .sa_handler = handle_report_signal };
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGUSR1, &sa, NULL);
+    printf("[LOCKS] Lock profiling on; kill -USR1 %d for a report\n", profile_owner);
+    return 0;
+}
+
+// Slot for this call site, claimed on first use by whichever process gets there
+static int find_site(const char *site, const char *func, LockKind kind) {
+    uintptr_t key = (uintptr_t)site;
+    for (int i = 0; i < LOCKPROF_SITES; i++) {
+        LockSite *s = &profile->sites[i];
+        uintptr_t cur = atomic_load_explicit(&s->key, memory_order_acquire);
+        if (cur == 0 && atomic_compare_exchange_strong(&s->key, &cur, key)) {
+            s->func = func;
+            s->kind = kind;
+            return i;
+        }
+        if (cur == key) return i;
+    }
+    return -1;
+}
+
+static void record_max(_Atomic uint64_t *max, uint64_t v) {
+    uint64_t cur = atomic_load_explicit(max, memory_order_relaxed);
+    while (v > cur && !atomic_compare_exchange_weak_explicit(max, &cur, v, memory_order_relaxed,
+                                                             memory_order_relaxed)) {}
+}
+
+void lockprof_acquire(GameState *gs, LockKind kind, const char *site, const char *func) {
+    sem_t *sem = table_sem(gs, kind);
+    if (profile == NULL) {
+        sem_wait(sem);
+        return;
+    }
+
+    int idx = find_site(site, func, kind);
+    bool waited = false;
+    uint64_t wait = 0;
+    if (sem_trywait(sem) != 0) {
+        uint64_t start = stats_now();
+        while (sem_wait(sem) != 0) {}
+        waited = true;
+        wait = stats_now() - start;
+    }
+
+    LockHold *hold = &profile->holds[gs->table_id * LOCK_KINDS + kind];
+    hold->acquired_ns = stats_now();
+    hold->site = idx;
+    if (idx < 0) {
+        atomic_fetch_add_explicit(&profile->unprofiled, 1, memory_order_relaxed);
+        return;
+    }
+
+    LockSite *s = &profile->sites[idx];
+    atomic_fetch_add_explicit(&s->acquired, 1, memory_order_relaxed);
+    if (waited) {
+        atomic_fetch_add_explicit(&s->contended, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&s->wait_ns, wait, memory_order_relaxed);
+        record_max(&s->wait_max, wait);
+    }
+}
+
+void lockprof_release(GameState *gs, LockKind kind) {
+    if (profile != NULL) {
+        // Still ours until the sem_post() below
+        LockHold *hold = &profile->holds[gs->table_id * LOCK_KINDS + kind];
+        if (hold->site >= 0) {
+            uint64_t held = stats_now() - hold->acquired_ns;
+            LockSite *s = &profile->sites[hold->site];
+            atomic_fetch_add_explicit(&s->hold_ns, held, memory_order_relaxed);
+            record_max(&s->hold_max, held);
+        }
+    }
+    sem_post(table_sem(gs, kind));
+}
+
+static const char *format_ns(char *buf, size_t size, uint64_t ns) {
+    if (ns < 10000ULL) {
+        snprintf(buf, size, "%lluns", (unsigned long long)ns);
+    } else if (ns < 10000000ULL) {
+        snprintf(buf, size, "%.1fus", (double)ns / 1e3);
+    } else {
+        snprintf(buf, size, "%.1fms", (double)ns / 1e6);
+    }
+    return buf;
+}
+
+void lockprof_report(void) {
+    if (profile == NULL) return;
+    // Normalized by the game's own pace, from the stats segment
+    uint64_t rounds = stats_samples(STAT_ROUND);
+    uint64_t actions = stats_counter(CTR_ACTIONS);
+    char a[16], b[16], c[16], d[16];
+
+    printf("[LOCKS] Lock profile after %llu rounds, %llu actions\n",
+           (unsigned long long)rounds, (unsigned long long)actions);
+    printf("  %-9s %-24s %-20s %9s %9s %9s %9s %9s %9s %9s\n", "lock", "site", "function",
+           "acquired", "/round", "waited", "wait avg", "wait max", "hold avg", "hold max");
+
+    uint64_t lock_acquired[LOCK_KINDS] = { 0 }, lock_waited[LOCK_KINDS] = { 0 };
+    uint64_t lock_wait_ns[LOCK_KINDS] = { 0 }, lock_hold_ns[LOCK_KINDS] = { 0 };
+    for (int k = 0; k < LOCK_KINDS; k++) {
+        for (int i = 0; i < LOCKPROF_SITES; i++) {
+            LockSite *s = &profile->sites[i];
+            const char *site = (const char *)atomic_load(&s->key);
+            if (site == NULL || s->kind != (LockKind)k) continue;
+
+            uint64_t acquired = atomic_load(&s->acquired);
+            uint64_t waited = atomic_load(&s->contended);
+            uint64_t wait_ns = atomic_load(&s->wait_ns), hold_ns = atomic_load(&s->hold_ns);
+            if (acquired == 0) continue;
+            lock_acquired[k] += acquired;
+            lock_waited[k] += waited;
+            lock_wait_ns[k] += wait_ns;
+            lock_hold_ns[k] += hold_ns;
+
+            double per_round = rounds ? (double)acquired / (double)rounds : 0.0;
+            double wait_rate = (double)waited / (double)acquired;
+            printf("  %-9s %-24s %-20s %9llu %9.2f %8.1f%% %9s %9s %9s %9s\n",
+                   lock_names[k], site, s->func ? s->func : "?", (unsigned long long)acquired,
+                   per_round, 100.0 * wait_rate,
+                   format_ns(a, sizeof(a), waited ? wait_ns / waited : 0),
+                   format_ns(b, sizeof(b), atomic_load(&s->wait_max)),
+                   format_ns(c, sizeof(c), hold_ns / acquired),
+                   format_ns(d, sizeof(d), atomic_load(&s->hold_max)));
+
+            double per_action = actions ? (double)acquired / (double)actions : 0.0;
+            if (per_action >= FLAG_PER_ACTION) {
+                printf("  ^ taken %.1f times per hit/stand: is it inside a polling loop?\n", per_action);
+            }
+            if (wait_rate >= FLAG_CONTENDED) {
+                printf("  ^ contended: %.1f%% of acquisitions waited\n", 100.0 * wait_rate);
+            } else if (waited == 0 && acquired >= FLAG_MIN_SAMPLES) {
+                printf("  ^ never contended in %llu acquisitions\n", (unsigned long long)acquired);
+            }
+        }
+    }
+
+    // Per lock: the one whose removal saves the most waiting goes first
+    for (int k = 0; k < LOCK_KINDS; k++) {
+        if (lock_acquired[k] == 0) continue;
+        printf("  %-9s total: %llu acquired, %llu waited (%s waiting, %s held)\n", lock_names[k],
+               (unsigned long long)lock_acquired[k], (unsigned long long)lock_waited[k],
+               format_ns(a, sizeof(a), lock_wait_ns[k]), format_ns(b, sizeof(b), lock_hold_ns[k]));
+    }
+    uint64_t unprofiled = atomic_load(&profile->unprofiled);
+    if (unprofiled) {
+        printf("  %llu acquisitions from sites past the first %d not shown\n",
+               (unsigned long long)unprofiled, LOCKPROF_SITES);
+    }
+    fflush(stdout);
+}
+
+void lockprof_poll(void) {
+    if (!report_requested || getpid() != profile_owner) return;
+    report_requested = 0;
+    lockprof_report();
+}
+
+#endif
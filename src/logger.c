@@ -1,22 +1,56 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
 #include <time.h>
 #include <pthread.h>
+#include <signal.h>
 #include <stddef.h>
-#include "game_state.h"
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "logger.h"
 
-// Added these to satisfy the Linker
-void init_logger() {
-    printf("[SYS] Logger system initialized.\n");
-}
+#define LOG_SHM_NAME "/blackjack_log"
+#define LOG_MASK (LOG_RING_SIZE - 1)
+#define LOG_BATCH_SIZE 65536
 
-void shutdown_logger() {
-    printf("[SYS] Logger system shutting down... logs flushed.\n");
+// Inherited by every forked worker and client process
+static LogRing *log_ring = NULL;
+
+// Only the process that called init_logger() runs the flusher
+static pthread_t flusher_tid;
+static pid_t flusher_owner = 0;
+
+// --- 1. PRODUCERS (any process, any thread) ---
+
+// Claim the next free slot; NULL if the ring is full
+static LogRecord* reserve_record(LogRing *ring, uint64_t *pos_out) {
+    uint64_t pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+    for (;;) {
+        LogRecord *rec = &ring->records[pos & LOG_MASK];
+        uint64_t seq = atomic_load_explicit(&rec->seq, memory_order_acquire);
+        int64_t diff = (int64_t)(seq - pos);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                *pos_out = pos;
+                return rec;
+            }
+        } else if (diff < 0) {
+            return NULL; // Flusher has not consumed this lap yet
+        } else {
+            pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+        }
+    }
 }
 
-void log_event(const char* type, const char* details) {
-    FILE *fp = fopen("game.log", "a");
+// Old synchronous path, used when init_logger() was never called
+static void write_direct(const char *type, const char *details) {
+    FILE *fp = fopen(LOG_FILE, "a");
     if (fp == NULL) return;
 
     time_t now = time(NULL);
@@ -27,9 +61,219 @@ void log_event(const char* type, const char* details) {
     fclose(fp);
 }
 
-void log_player_connect(int id) { (void)id; log_event("CONN", "Player connected"); }
-void log_player_disconnect(int id) { (void)id; log_event("DISC", "Player disconnected"); }
-void log_card_dealt(int id, int val) { (void)id; (void)val; log_event("DEAL", "Card dealt"); }
-void log_player_action(int id, const char* act, int pts) { (void)id; (void)pts; log_event("ACT", act); }
-void log_game_start(int count) { (void)count; log_event("START", "Game on"); }
-void log_game_end(int winner) { (void)winner; log_event("END", "Game over"); }
\ No newline at end of file
+static void log_eventf(const char *type, const char *fmt, ...) {
+    LogRing *ring = log_ring;
+    va_list ap;
+
+    if (ring == NULL) {
+        char details[LOG_DETAIL_LEN];
+        va_start(ap, fmt);
+        vsnprintf(details, sizeof(details), fmt, ap);
+        va_end(ap);
+        write_direct(type, details);
+        return;
+    }
+
+    uint64_t pos;
+    LogRecord *rec;
+    for (;;) {
+        uint32_t seen = wq_prepare(&ring->space_wq);
+        rec = reserve_record(ring, &pos);
+        if (rec) break;
+
+        if (ring->policy == LOG_FULL_DROP || atomic_load(&ring->stopping)) {
+            atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+            return;
+        }
+        wq_wake_all(&ring->data_wq);
+        wq_wait(&ring->space_wq, seen, LOG_FLUSH_MS);
+    }
+
+    // Formatting happens here, in the caller; no syscalls on this path
+    rec->when = time(NULL);
+    strncpy(rec->type, type, LOG_TYPE_LEN - 1);
+    rec->type[LOG_TYPE_LEN - 1] = '\0';
+    va_start(ap, fmt);
+    vsnprintf(rec->details, LOG_DETAIL_LEN, fmt, ap);
+    va_end(ap);
+    atomic_store_explicit(&rec->seq, pos + 1, memory_order_release);
+
+    // Past half full: don't wait for the flusher's next interval
+    uint64_t tail = atomic_load_explicit(&ring->dequeue_pos, memory_order_relaxed);
+    if (pos - tail >= LOG_RING_SIZE / 2) {
+        wq_wake_all(&ring->data_wq);
+    }
+}
+
+// --- 2. FLUSHER (background thread of the master) ---
+
+static void write_all(int fd, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n <= 0) return;
+        buf += n;
+        len -= (size_t)n;
+    }
+}
+
+typedef struct {
+    int fd;
+    char buf[LOG_BATCH_SIZE];
+    size_t len;
+    time_t stamp_when;  // ctime()-style stamp is only re-rendered once a second
+    char stamp[32];
+} LogBatch;
+
+static void batch_append(LogBatch *b, time_t when, const char *type, const char *details) {
+    if (when != b->stamp_when || b->stamp[0] == '\0') {
+        struct tm tm;
+        localtime_r(&when, &tm);
+        strftime(b->stamp, sizeof(b->stamp), "%a %b %e %H:%M:%S %Y", &tm);
+        b->stamp_when = when;
+    }
+
+    // Worst-case line: stamp + type + details + punctuation
+    if (b->len + sizeof(b->stamp) + LOG_TYPE_LEN + LOG_DETAIL_LEN + 8 > sizeof(b->buf)) {
+        write_all(b->fd, b->buf, b->len);
+        b->len = 0;
+    }
+    b->len += (size_t)snprintf(b->buf + b->len, sizeof(b->buf) - b->len,
+                               "[%s] %s: %s\n", b->stamp, type, details);
+}
+
+// Consume every published record; returns how many were taken
+static int drain_ring(LogRing *ring, LogBatch *b) {
+    int taken = 0;
+    uint64_t pos = atomic_load_explicit(&ring->dequeue_pos, memory_order_relaxed);
+
+    for (;;) {
+        LogRecord *rec = &ring->records[pos & LOG_MASK];
+        uint64_t seq = atomic_load_explicit(&rec->seq, memory_order_acquire);
+        if (seq != pos + 1) break; // Empty, or a producer is mid-write
+
+        batch_append(b, rec->when, rec->type, rec->details);
+        atomic_store_explicit(&rec->seq, pos + LOG_RING_SIZE, memory_order_release);
+        pos++;
+        atomic_store_explicit(&ring->dequeue_pos, pos, memory_order_relaxed);
+        taken++;
+    }
+
+    uint64_t dropped = atomic_exchange_explicit(&ring->dropped, 0, memory_order_relaxed);
+    if (dropped > 0) {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "%llu records dropped (ring full)",
+                 (unsigned long long)dropped);
+        batch_append(b, time(NULL), "LOG", msg);
+    }
+    return taken;
+}
+
+static void* flusher_thread_func(void *arg) {
+    LogRing *ring = arg;
+    LogBatch *b = calloc(1, sizeof(LogBatch));
+    if (!b) return NULL;
+
+    b->fd = open(LOG_FILE, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (b->fd < 0) {
+        perror("[ERROR] Cannot open " LOG_FILE);
+        free(b);
+        return NULL;
+    }
+
+    for (;;) {
+        uint32_t seen = wq_prepare(&ring->data_wq);
+        bool stopping = atomic_load(&ring->stopping);
+
+        int taken = drain_ring(ring, b);
+        if (b->len > 0) {
+            write_all(b->fd, b->buf, b->len); // One write() per batch
+            b->len = 0;
+        }
+        if (taken > 0) wq_wake_all(&ring->space_wq);
+
+        // Producers that finished before 'stopping' was seen are all written
+        if (stopping && taken == 0) break;
+
+        wq_wait(&ring->data_wq, seen, LOG_FLUSH_MS);
+    }
+
+    close(b->fd);
+    free(b);
+    return NULL;
+}
+
+// --- 3. LIFECYCLE ---
+
+int init_logger(LogFullPolicy policy) {
+    int fd = shm_open(LOG_SHM_NAME, O_CREAT | O_RDWR, 0666);
+    if (fd == -1) {
+        perror("[ERROR] Logger shm_open failed");
+        return -1;
+    }
+    if (ftruncate(fd, sizeof(LogRing)) == -1) {
+        perror("[ERROR] Logger ftruncate failed");
+        close(fd);
+        return -1;
+    }
+    LogRing *ring = mmap(NULL, sizeof(LogRing), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ring == MAP_FAILED) {
+        perror("[ERROR] Logger mmap failed");
+        return -1;
+    }
+
+    memset(ring, 0, sizeof(LogRing));
+    ring->policy = policy;
+    for (uint64_t i = 0; i < LOG_RING_SIZE; i++) {
+        atomic_store_explicit(&ring->records[i].seq, i, memory_order_relaxed);
+    }
+
+    // Shutdown and report signals must land on the main thread, never on the flusher
+    sigset_t block, old;
+    sigemptyset(&block);
+    sigaddset(&block, SIGINT);
+    sigaddset(&block, SIGTERM);
+    sigaddset(&block, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+    int rc = pthread_create(&flusher_tid, NULL, flusher_thread_func, ring);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (rc != 0) {
+        fprintf(stderr, "[ERROR] Failed to create logger flusher thread\n");
+        munmap(ring, sizeof(LogRing));
+        shm_unlink(LOG_SHM_NAME);
+        return -1;
+    }
+
+    log_ring = ring;
+    flusher_owner = getpid();
+    printf("[SYS] Logger system initialized (%d-record ring, %s when full).\n",
+           LOG_RING_SIZE, policy == LOG_FULL_DROP ? "drop" : "block");
+    return 0;
+}
+
+void shutdown_logger(void) {
+    LogRing *ring = log_ring;
+    if (ring == NULL || flusher_owner != getpid()) return;
+
+    atomic_store(&ring->stopping, 1);
+    wq_wake_all(&ring->data_wq);
+    pthread_join(flusher_tid, NULL);
+
+    log_ring = NULL;
+    munmap(ring, sizeof(LogRing));
+    shm_unlink(LOG_SHM_NAME);
+    printf("[SYS] Logger system shutting down... logs flushed.\n");
+}
+
+// --- 4. EVENT HELPERS ---
+
+void log_event(const char* type, const char* details) { log_eventf(type, "%s", details); }
+
+void log_player_connect(int id) { log_eventf("CONN", "Player %d connected", id); }
+void log_player_disconnect(int id) { log_eventf("DISC", "Player %d disconnected", id); }
+void log_card_dealt(int id, int val) { log_eventf("DEAL", "Card %d dealt to Player %d", val, id); }
+void log_player_action(int id, const char* act, int pts) {
+    log_eventf("ACT", "Player %d: %s (%d points)", id, act, pts);
+}
+void log_game_start(int count) { log_eventf("START", "Game on with %d players", count); }
+void log_game_end(int winner) { log_eventf("END", "Game over, winner Player %d", winner); }
@@ -2,21 +2,46 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <errno.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include "network.h"
 
+static void server_address(const char *ip, struct sockaddr_in *serv_addr) {
+    memset(serv_addr, 0, sizeof(*serv_addr));
+    serv_addr->sin_family = AF_INET;
+    serv_addr->sin_port = htons(8888);
+    inet_pton(AF_INET, ip, &serv_addr->sin_addr);
+}
+
 int connect_to_server(const char *ip) {
     int sock = socket(AF_INET, SOCK_STREAM, 0);
     struct sockaddr_in serv_addr;
-    serv_addr.sin_family = AF_INET;
-    serv_addr.sin_port = htons(8888);
-    inet_pton(AF_INET, ip, &serv_addr.sin_addr);
+    server_address(ip, &serv_addr);
     connect(sock, (struct sockaddr *)&serv_addr, sizeof(serv_addr));
     return sock;
 }
 
+int connect_to_server_async(const char *ip) {
+    int sock = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (sock < 0) return -1;
+    struct sockaddr_in serv_addr;
+    server_address(ip, &serv_addr);
+    if (connect(sock, (struct sockaddr *)&serv_addr, sizeof(serv_addr)) < 0 && errno != EINPROGRESS) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+int connect_result(int sock) {
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &len) < 0) return errno;
+    return err;
+}
+
 int receive_message(int sock, char *buf, int size) {
     int bytes = recv(sock, buf, size - 1, 0);
     if (bytes > 0) buf[bytes] = '\0';
@@ -24,9 +49,135 @@ int receive_message(int sock, char *buf, int size) {
 }
 
 void send_message(int sock, const char *msg) {
-    send(sock, msg, strlen(msg), 0);
+    size_t len = strlen(msg);
+    while (len > 0) {
+        ssize_t n = send(sock, msg, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        msg += n;
+        len -= (size_t)n;
+    }
 }
 
 void close_connection(int sock) {
     close(sock);
-}
\ No newline at end of file
+}
+// --- BUFFERED CONNECTIONS ---
+
+static ssize_t plain_send(int fd, const void *buf, size_t len, int flags) {
+    return send(fd, buf, len, flags);
+}
+
+static ssize_t plain_recv(int fd, void *buf, size_t len, int flags) {
+    return recv(fd, buf, len, flags);
+}
+
+void conn_init(Conn *c, int fd, ConnSendFn send_fn, ConnRecvFn recv_fn) {
+    memset(c, 0, sizeof(*c));
+    c->fd = fd;
+    c->send_fn = send_fn ? send_fn : plain_send;
+    c->recv_fn = recv_fn ? recv_fn : plain_recv;
+}
+
+void conn_free(Conn *c) {
+    free(c->out);
+    c->out = NULL;
+    c->out_len = c->out_cap = 0;
+}
+
+ssize_t conn_fill(Conn *c) {
+    // Consumed bytes are only moved out of the way when room runs short
+    if (c->in_start > 0 && c->in_len == sizeof(c->in)) {
+        memmove(c->in, c->in + c->in_start, c->in_len - c->in_start);
+        c->in_len -= c->in_start;
+        c->in_start = 0;
+    }
+    if (c->in_len == sizeof(c->in)) {
+        errno = ENOBUFS;
+        return -1;
+    }
+    ssize_t n = c->recv_fn(c->fd, c->in + c->in_len, sizeof(c->in) - c->in_len, 0);
+    if (n > 0) c->in_len += (size_t)n;
+    return n;
+}
+
+bool conn_line(Conn *c, char *line, size_t cap) {
+    size_t avail = c->in_len - c->in_start;
+    const char *start = c->in + c->in_start;
+    const char *nl = memchr(start, '\n', avail);
+    size_t len, used;
+    if (nl) {
+        len = (size_t)(nl - start);
+        used = len + 1;
+        if (len > 0 && start[len - 1] == '\r') len--;
+    } else if (avail == sizeof(c->in)) {
+        len = used = avail;
+    } else {
+        return false;
+    }
+    if (len >= cap) len = cap - 1;
+    memcpy(line, start, len);
+    line[len] = '\0';
+    conn_consume(c, used);
+    return true;
+}
+
+const char* conn_data(const Conn *c, size_t *len) {
+    *len = c->in_len - c->in_start;
+    return c->in + c->in_start;
+}
+
+void conn_consume(Conn *c, size_t n) {
+    c->in_start += n;
+    if (c->in_start >= c->in_len) c->in_start = c->in_len = 0;
+}
+
+bool conn_queue(Conn *c, const void *buf, size_t len) {
+    if (c->failed) return false;
+    if (c->out_len + len > c->out_cap) {
+        size_t cap = c->out_cap ? c->out_cap : 256;
+        while (cap < c->out_len + len) cap *= 2;
+        char *grown = realloc(c->out, cap);
+        if (!grown) {
+            c->failed = true;
+            conn_free(c);
+            return false;
+        }
+        c->out = grown;
+        c->out_cap = cap;
+    }
+    memcpy(c->out + c->out_len, buf, len);
+    c->out_len += len;
+    return true;
+}
+
+int conn_flush(Conn *c) {
+    if (c->failed) return -1;
+    if (c->out_len == 0) return 0;
+    size_t sent = 0;
+    while (sent < c->out_len) {
+        ssize_t n = c->send_fn(c->fd, c->out + sent, c->out_len - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += (size_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            c->failed = true;
+            conn_free(c);
+            return -1;
+        }
+    }
+    memmove(c->out, c->out + sent, c->out_len - sent);
+    c->out_len -= sent;
+    if (c->out_len > 0) return 1;
+    // Keep a turn-sized buffer for the next turn; only a burst that grew
+    // it past CONN_OUT_KEEP is given back
+    if (c->out_cap > CONN_OUT_KEEP) conn_free(c);
+    return 0;
+}
+
+size_t conn_pending(const Conn *c) {
+    return c->out_len;
+}
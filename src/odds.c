@@ -0,0 +1,78 @@
+// src/odds.c
+#include <string.h>
+#include "odds.h"
+#include "rules.h"
+
+// --- 1. SHOE COUNTS ---
+
+static void count_fresh(ShoeCounts *c, int decks) {
+    for (int v = 1; v < 10; v++) c->count[v - 1] = (uint16_t)(4 * decks);
+    c->count[9] = (uint16_t)(16 * decks);
+    c->total = (uint16_t)(DECK_SIZE * decks);
+}
+
+void odds_count(ShoeCounts *c, const uint8_t *cards, int n) {
+    memset(c, 0, sizeof(*c));
+    for (int i = 0; i < n; i++) {
+        int v = cards[i] >= 10 ? 10 : cards[i];
+        c->count[v - 1]++;
+    }
+    c->total = (uint16_t)n;
+}
+
+void odds_sync(ShoeCounts *c, const Shoe *shoe) {
+    for (;;) {
+        uint64_t cursor = atomic_load_explicit(&shoe->cursor, memory_order_acquire);
+        uint32_t gen = SHOE_GEN(cursor);
+        uint32_t dealt = SHOE_IDX(cursor);
+        if (dealt > (uint32_t)shoe->size) dealt = (uint32_t)shoe->size;
+        const uint8_t *cards = shoe->cards[gen & 1];
+
+        // Work on a copy: a read that raced a reshuffle is thrown away
+        ShoeCounts next = *c;
+        if (!c->synced || c->gen != gen || c->dealt > dealt) {
+            odds_count(&next, cards + dealt, shoe->size - (int)dealt);
+        } else {
+            for (uint32_t i = c->dealt; i < dealt; i++) odds_remove(&next, cards[i]);
+        }
+        if (next.total == 0) count_fresh(&next, shoe->size / DECK_SIZE);
+
+        // A buffer is only reshuffled once the generation has moved past it
+        uint64_t after = atomic_load_explicit(&shoe->cursor, memory_order_acquire);
+        if (SHOE_GEN(after) != gen) continue;
+
+        next.synced = true;
+        next.gen = gen;
+        next.dealt = dealt;
+        *c = next;
+        return;
+    }
+}
+
+// --- 2. ONE DECISION ---
+
+void odds_stand(int hard_total, int aces, OddsDist *out) {
+    memset(out, 0, sizeof(*out));
+    if (hard_total > 21) {
+        out->bust = 1.0f;
+    } else {
+        out->total[hand_total(hard_total, aces)] = 1.0f;
+    }
+}
+
+void odds_hit(const ShoeCounts *c, int hard_total, int aces, OddsDist *out) {
+    if (c->total == 0 || hard_total > 21) {
+        odds_stand(hard_total, aces, out);
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+    for (int v = 1; v <= ODDS_VALUES; v++) {
+        float p = (float)c->count[v - 1] / (float)c->total;
+        int hard = hard_total + v;
+        if (hard > 21) {
+            out->bust += p;
+        } else {
+            out->total[hand_total(hard, aces + (v == 1))] += p;
+        }
+    }
+}
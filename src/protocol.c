@@ -0,0 +1,258 @@
+// src/protocol.c
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include "protocol.h"
+
+// Payloads are byte arrays only, so their layout is the wire layout
+_Static_assert(sizeof(ProtoHeader) == 3, "ProtoHeader must be packed");
+_Static_assert(sizeof(ProtoState) == 7 + MAX_CARDS, "ProtoState must be packed");
+_Static_assert(sizeof(ProtoDelta) == 9, "ProtoDelta must be packed");
+_Static_assert(sizeof(ProtoRound) == 3, "ProtoRound must be packed");
+_Static_assert(sizeof(ProtoHeader) + sizeof(ProtoState) <= PROTO_MAX_FRAME,
+               "PROTO_MAX_FRAME too small");
+_Static_assert(sizeof(ProtoHeader) + sizeof(ProtoDelta) + MAX_CARDS <= PROTO_MAX_FRAME,
+               "PROTO_MAX_FRAME too small");
+
+// --- 1. ENCODING ---
+
+// Fills in the header; the payload goes right after it
+static void* frame_begin(uint8_t *buf, ProtoType type, size_t payload_len) {
+    ProtoHeader *h = (ProtoHeader *)buf;
+    proto_put16(h->len, (unsigned)payload_len);
+    h->type = (uint8_t)type;
+    return buf + sizeof(ProtoHeader);
+}
+
+size_t proto_hello(uint8_t *buf) {
+    ProtoHello *m = frame_begin(buf, MSG_HELLO, sizeof(*m));
+    m->magic[0] = PROTO_MAGIC_0;
+    m->magic[1] = PROTO_MAGIC_1;
+    m->version = PROTO_VERSION;
+    return sizeof(ProtoHeader) + sizeof(*m);
+}
+
+size_t proto_hello_ack(uint8_t *buf, int seat, int table) {
+    ProtoHelloAck *m = frame_begin(buf, MSG_HELLO_ACK, sizeof(*m));
+    m->version = PROTO_VERSION;
+    m->seat = (uint8_t)seat;
+    proto_put16(m->table, (unsigned)table);
+    return sizeof(ProtoHeader) + sizeof(*m);
+}
+
+size_t proto_action(uint8_t *buf, ProtoAction action) {
+    ProtoActionMsg *m = frame_begin(buf, MSG_ACTION, sizeof(*m));
+    m->action = (uint8_t)action;
+    return sizeof(ProtoHeader) + sizeof(*m);
+}
+
+static void fill_state(ProtoState *m, const TableSnapshot *snap, int seat) {
+    const PlayerState *p = &snap->players[seat];
+    int count = p->card_count < MAX_CARDS ? p->card_count : MAX_CARDS;
+
+    proto_put16(m->version, snap->state_version);
+    m->turn = (uint8_t)snap->current_turn;
+    m->seat = (uint8_t)seat;
+    m->points = (uint8_t)p->points;
+    m->flags = p->standing ? STATE_STANDING : 0;
+    m->card_count = (uint8_t)count;
+    memset(m->cards, 0, sizeof(m->cards));
+    for (int i = 0; i < count; i++) {
+        m->cards[i] = (uint8_t)p->cards[i];
+    }
+}
+
+size_t proto_state(uint8_t *buf, const TableSnapshot *snap, int seat) {
+    ProtoState *m = frame_begin(buf, MSG_STATE, sizeof(*m));
+    fill_state(m, snap, seat);
+    return sizeof(ProtoHeader) + sizeof(*m);
+}
+
+size_t proto_resync(uint8_t *buf) {
+    frame_begin(buf, MSG_RESYNC, 0);
+    return sizeof(ProtoHeader);
+}
+
+size_t proto_state_update(uint8_t *buf, StateView *view, const TableSnapshot *snap, int seat) {
+    ProtoState now;
+    ProtoState *sent = &view->sent;
+    fill_state(&now, snap, seat);
+
+    // A shorter or different hand means a new round: deltas only append
+    bool redealt = now.card_count < sent->card_count ||
+                   memcmp(now.cards, sent->cards, sent->card_count) != 0;
+
+    if (!view->valid || redealt || view->deltas >= PROTO_SNAPSHOT_EVERY) {
+        ProtoState *m = frame_begin(buf, MSG_STATE, sizeof(*m));
+        *m = now;
+        view->sent = now;
+        view->valid = true;
+        view->deltas = 0;
+        return sizeof(ProtoHeader) + sizeof(*m);
+    }
+
+    uint8_t changed = 0;
+    if (now.turn != sent->turn) changed |= DELTA_TURN;
+    if (now.points != sent->points) changed |= DELTA_POINTS;
+    if (now.flags != sent->flags) changed |= DELTA_STANDING;
+    if (now.card_count > sent->card_count) changed |= DELTA_CARDS;
+    if (changed == 0) return 0;
+
+    size_t new_cards = (size_t)(now.card_count - sent->card_count);
+    size_t payload = sizeof(ProtoDelta) + new_cards;
+    ProtoDelta *d = frame_begin(buf, MSG_DELTA, payload);
+    memcpy(d->version, now.version, sizeof(d->version));
+    memcpy(d->base, sent->version, sizeof(d->base));
+    d->changed = changed;
+    d->turn = now.turn;
+    d->points = now.points;
+    d->flags = now.flags;
+    d->first_card = sent->card_count;
+    memcpy(d->cards, now.cards + sent->card_count, new_cards);
+
+    view->sent = now;
+    view->deltas++;
+    return sizeof(ProtoHeader) + payload;
+}
+
+size_t proto_round(uint8_t *buf, RoundEvent event, int arg) {
+    ProtoRound *m = frame_begin(buf, MSG_ROUND, sizeof(*m));
+    m->event = (uint8_t)event;
+    proto_put16(m->arg, (unsigned)arg);
+    return sizeof(ProtoHeader) + sizeof(*m);
+}
+
+size_t proto_result(uint8_t *buf, int winner, int points) {
+    ProtoResult *m = frame_begin(buf, MSG_RESULT, sizeof(*m));
+    m->winner = winner < 0 ? PROTO_NO_PLAYER : (uint8_t)winner;
+    m->points = (uint8_t)points;
+    return sizeof(ProtoHeader) + sizeof(*m);
+}
+
+// --- 2. DECODING ---
+
+// Only DELTA varies in length (its trailing cards); the rest are fixed
+static bool payload_fits(uint8_t type, size_t len) {
+    switch (type) {
+    case MSG_HELLO:     return len == sizeof(ProtoHello);
+    case MSG_ACTION:    return len == sizeof(ProtoActionMsg);
+    case MSG_RESYNC:    return len == 0;
+    case MSG_HELLO_ACK: return len == sizeof(ProtoHelloAck);
+    case MSG_STATE:     return len == sizeof(ProtoState);
+    case MSG_ROUND:     return len == sizeof(ProtoRound);
+    case MSG_RESULT:    return len == sizeof(ProtoResult);
+    case MSG_DELTA:     return len >= sizeof(ProtoDelta) && len <= sizeof(ProtoDelta) + MAX_CARDS;
+    default:            return false;
+    }
+}
+
+int proto_next_frame(const uint8_t *buf, size_t avail, const ProtoHeader **hdr) {
+    if (avail < sizeof(ProtoHeader)) return 0;
+
+    const ProtoHeader *h = (const ProtoHeader *)buf;
+    size_t len = proto_get16(h->len);
+    if (!payload_fits(h->type, len)) return -1;
+
+    if (avail < sizeof(ProtoHeader) + len) return 0;
+    *hdr = h;
+    return (int)(sizeof(ProtoHeader) + len);
+}
+
+bool proto_is_hello(const ProtoHeader *hdr) {
+    if (hdr->type != MSG_HELLO) return false;
+    const ProtoHello *m = proto_payload(hdr);
+    return m->magic[0] == PROTO_MAGIC_0 && m->magic[1] == PROTO_MAGIC_1 &&
+           m->version == PROTO_VERSION;
+}
+
+bool proto_apply_delta(ProtoState *state, const ProtoHeader *delta) {
+    const ProtoDelta *d = proto_payload(delta);
+    size_t new_cards = proto_get16(delta->len) - sizeof(ProtoDelta);
+
+    if (memcmp(d->base, state->version, sizeof(d->base)) != 0) return false;
+    if (d->first_card != state->card_count || d->first_card + new_cards > MAX_CARDS) return false;
+
+    memcpy(state->version, d->version, sizeof(state->version));
+    state->turn = d->turn;
+    state->points = d->points;
+    state->flags = d->flags;
+    memcpy(state->cards + state->card_count, d->cards, new_cards);
+    state->card_count = (uint8_t)(d->first_card + new_cards);
+    return true;
+}
+
+// --- 3. LEGACY TEXT ---
+
+size_t proto_state_text(const ProtoState *m, char *out, size_t cap) {
+    char card_list[4 * MAX_CARDS + 1];
+    size_t n = 0;
+
+    card_list[0] = '\0';
+    for (int i = 0; i < m->card_count && i < MAX_CARDS; i++) {
+        n += (size_t)snprintf(card_list + n, sizeof(card_list) - n, "%d%s",
+                              m->cards[i], (i == m->card_count - 1 ? "" : ","));
+    }
+    return (size_t)snprintf(out, cap,
+                            "STATE: turn=%d player_id=%d cards=%s points=%d standing=%s\n",
+                            m->turn, m->seat, card_list, m->points,
+                            (m->flags & STATE_STANDING) ? "true" : "false");
+}
+
+static size_t render_round(const ProtoRound *m, char *out, size_t cap) {
+    int arg = proto_get16(m->arg);
+
+    switch (m->event) {
+    case EV_WAITING_PLAYERS:
+        return (size_t)snprintf(out, cap, "MESSAGE: Waiting for Player 2 to join...\n");
+    case EV_ROUND_START:
+        return (size_t)snprintf(out, cap, "MESSAGE: Starting Round %d\n", arg);
+    case EV_NOT_YOUR_TURN:
+        return (size_t)snprintf(out, cap, "MESSAGE: Not Player %d's turn. Waiting...\n", arg);
+    case EV_YOUR_TURN:
+        // The bust odds in arg are for binary clients; the text prompt stays as it was
+        return (size_t)snprintf(out, cap, "MESSAGE: Player's turn! hit or stand?\nYour action: ");
+    case EV_CONTINUE_VOTE:
+        return (size_t)snprintf(out, cap, "MESSAGE: Do you want to play another round? (yes/no)\n");
+    case EV_WAITING_VOTES:
+        return (size_t)snprintf(out, cap, "MESSAGE: Waiting for other players to decide...\n");
+    case EV_LEAVING:
+        return (size_t)snprintf(out, cap, "MESSAGE: Player %d is leaving. Thanks for playing!\n", arg);
+    case EV_GAME_ENDING:
+        return (size_t)snprintf(out, cap, "MESSAGE: Not enough players to continue. Game ending.\n");
+    default:
+        return 0;
+    }
+}
+
+size_t proto_to_text(const ProtoHeader *hdr, char *out, size_t cap) {
+    size_t n = 0;
+
+    switch (hdr->type) {
+    case MSG_STATE:
+        n = proto_state_text(proto_payload(hdr), out, cap);
+        break;
+    case MSG_ROUND:
+        n = render_round(proto_payload(hdr), out, cap);
+        break;
+    case MSG_RESULT: {
+        const ProtoResult *m = proto_payload(hdr);
+        if (m->winner != PROTO_NO_PLAYER) {
+            n = (size_t)snprintf(out, cap,
+                                 "STATE: Game Over\nMESSAGE: Winner is Player %d with %d points\n",
+                                 m->winner, m->points);
+        }
+        break;
+    }
+    default:
+        break; // HELLO_ACK has no text form, DELTA needs the client's STATE
+    }
+    return n < cap ? n : cap - 1;
+}
+
+ProtoAction proto_parse_text(const char *line) {
+    if (strncasecmp(line, "hit", 3) == 0) return ACT_HIT;
+    if (strncasecmp(line, "stand", 5) == 0) return ACT_STAND;
+    if (strncasecmp(line, "yes", 3) == 0) return ACT_CONTINUE;
+    if (strncasecmp(line, "no", 2) == 0) return ACT_LEAVE;
+    return ACT_NONE;
+}
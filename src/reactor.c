@@ -0,0 +1,930 @@
+// src/reactor.c
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include "game_state.h"
+#include "game_logic.h"
+#include "shared_mem.h"
+#include "reactor.h"
+#include "logger.h"
+#include "protocol.h"
+#include "capture.h"
+#include "stats.h"
+#include "timer_wheel.h"
+#include "spectator.h"
+#include "network.h"
+#include "odds.h"
+
+#define MAX_EVENTS 256
+#define VOTE_TIMEOUT 30      // Seconds before an unanswered continue vote counts as "no"
+
+/**
+ * Per-connection state machine. Each state is one of the places where the
+ * blocking handle_client() used to sit in recv() or a usleep() loop.
+ */
+typedef enum {
+    SESS_HELLO,           // Just accepted, waiting for a binary hello
+    SESS_WAITING_PLAYERS, // Seated, waiting for a second player / next round
+    SESS_IN_TURN,         // Round running, someone else is acting
+    SESS_AWAITING_ACTION, // Prompted, waiting for "hit" or "stand"
+    SESS_ROUND_OVER,      // Voted yes, waiting for the rest of the table
+    SESS_CONTINUE_VOTE,   // Asked "another round?", waiting for yes/no
+    SESS_CLOSING
+} SessionState;
+
+typedef struct {
+    Conn conn;            // Socket plus buffered input and queued output
+    GameState *gs;
+    ShoeCounts *odds;     // Its table's entry in Reactor.odds
+    int seat;
+    SessionState state;
+    WireMode mode;
+    StateView view;       // Last STATE a binary client holds
+    time_t vote_started;
+    uint64_t hello_due;   // End of the protocol negotiation window
+
+    // stats_now() stamps, cleared once the STATE they wait for goes out
+    uint64_t accepted_ns;
+    uint64_t action_ns;
+    uint32_t prompted_seq; // turn_seq of the last YOUR_TURN prompt
+} Session;
+
+// Pending deadline. Each queue holds one constant timeout (continue vote,
+// hello window), so deadlines are queued in FIFO order and only the head
+// ever needs checking.
+typedef struct {
+    int table;
+    uint64_t due_ms;
+} Deadline;
+
+typedef struct {
+    Deadline *items;
+    size_t head, count, cap;
+} DeadlineQueue;
+
+typedef struct {
+    int epfd;
+    int listen_sock;
+    TableRange *range;
+    Session **seats;    // range->count * MAX_PLAYERS slots
+    ShoeCounts *odds;   // Per table: what is left in its shoe (turn prompts)
+    bool *dirty;        // Tables touched by the current batch of events
+    int *dirty_list;
+    int dirty_count;
+
+    // Tables changed by the scheduler thread, handed over via eventfd
+    int notify_fd;
+    pthread_t loop_thread;
+    pthread_mutex_t pending_lock;
+    bool *pending;
+    int *pending_list;
+    int pending_count;
+
+    DeadlineQueue votes;
+    DeadlineQueue hellos;
+
+    SpectatorHub *spectators;
+
+    // Players seated by other workers arrive on handoff[own id][0]
+    int (*handoff)[2];
+} Reactor;
+
+// What comes with a handed-off connection (the socket rides as SCM_RIGHTS)
+typedef struct {
+    int table;
+    int seat;
+    uint64_t accepted_ns;
+} Handoff;
+
+// Mark the eventfd, the spectator hub and the handoff socket in
+// epoll_event.data.ptr (NULL marks the listener)
+static char notify_marker;
+static char spectator_marker;
+static char handoff_marker;
+static Reactor *active_reactor = NULL;
+
+static Session **table_seats(Reactor *r, GameState *gs) {
+    return &r->seats[(gs->table_id - r->range->first) * MAX_PLAYERS];
+}
+
+static void mark_dirty(Reactor *r, GameState *gs) {
+    int t = gs->table_id - r->range->first;
+    if (!r->dirty[t]) {
+        r->dirty[t] = true;
+        r->dirty_list[r->dirty_count++] = t;
+    }
+}
+
+/**
+ * table_notify_hook: runs on whichever thread changed the table. Changes
+ * made by the event loop itself are already marked dirty; anything else
+ * (the scheduler thread) is queued and the loop is woken via eventfd.
+ */
+static void reactor_notify(GameState *gs) {
+    Reactor *r = active_reactor;
+    if (!r || pthread_equal(pthread_self(), r->loop_thread)) return;
+
+    int t = gs->table_id - r->range->first;
+    if (t < 0 || t >= r->range->count) return;
+
+    pthread_mutex_lock(&r->pending_lock);
+    bool first = r->pending_count == 0;
+    if (!r->pending[t]) {
+        r->pending[t] = true;
+        r->pending_list[r->pending_count++] = t;
+    }
+    pthread_mutex_unlock(&r->pending_lock);
+
+    if (first) {
+        uint64_t one = 1;
+        ssize_t rc = write(r->notify_fd, &one, sizeof(one));
+        (void)rc;
+    }
+}
+
+static void drain_notifications(Reactor *r) {
+    uint64_t count;
+    while (read(r->notify_fd, &count, sizeof(count)) > 0) { }
+
+    pthread_mutex_lock(&r->pending_lock);
+    for (int i = 0; i < r->pending_count; i++) {
+        int t = r->pending_list[i];
+        r->pending[t] = false;
+        mark_dirty(r, &r->range->dir->tables[r->range->first + t]);
+    }
+    r->pending_count = 0;
+    pthread_mutex_unlock(&r->pending_lock);
+}
+
+static void push_deadline(Reactor *r, DeadlineQueue *q, GameState *gs, uint64_t due_ms) {
+    int t = gs->table_id - r->range->first;
+    if (q->count > 0) {
+        Deadline *last = &q->items[(q->head + q->count - 1) % q->cap];
+        if (last->table == t && last->due_ms == due_ms) return;
+    }
+    if (q->count == q->cap) {
+        size_t cap = q->cap ? q->cap * 2 : 64;
+        Deadline *grown = malloc(cap * sizeof(Deadline));
+        if (!grown) return; // the deadline then only fires on the next table event
+        for (size_t i = 0; i < q->count; i++) {
+            grown[i] = q->items[(q->head + i) % q->cap];
+        }
+        free(q->items);
+        q->items = grown;
+        q->cap = cap;
+        q->head = 0;
+    }
+    q->items[(q->head + q->count) % q->cap] = (Deadline){ t, due_ms };
+    q->count++;
+}
+
+// Marks tables whose deadline passed; returns ms until the next one
+static int expire_deadlines(Reactor *r, DeadlineQueue *q, uint64_t now) {
+    while (q->count > 0) {
+        Deadline *head = &q->items[q->head];
+        if (head->due_ms > now) {
+            return (int)(head->due_ms - now);
+        }
+        mark_dirty(r, &r->range->dir->tables[r->range->first + head->table]);
+        q->head = (q->head + 1) % q->cap;
+        q->count--;
+    }
+    return -1; // Nothing pending: sleep until an event arrives
+}
+
+static int expire_all(Reactor *r) {
+    uint64_t now = tw_now_ms();
+    int votes = expire_deadlines(r, &r->votes, now);
+    int hellos = expire_deadlines(r, &r->hellos, now);
+    if (votes < 0) return hellos;
+    if (hellos < 0) return votes;
+    return votes < hellos ? votes : hellos;
+}
+
+// --- 1. SOCKET HELPERS ---
+
+static int set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) return -1;
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+// Allow one process to hold tens of thousands of sockets
+static void raise_fd_limit(void) {
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+}
+
+// A full socket keeps the rest queued; EPOLLOUT resumes it
+static void session_flush(Session *s) {
+    if (conn_flush(&s->conn) < 0) s->state = SESS_CLOSING;
+}
+
+// Queued only: sync_table() flushes each session once per loop turn
+static void session_send(Session *s, const char *msg, size_t len) {
+    if (s->state == SESS_CLOSING) return;
+    if (!conn_queue(&s->conn, msg, len)) s->state = SESS_CLOSING;
+}
+
+// Queues one frame, rendered as the text protocol unless the client said hello
+static void session_frame(Session *s, const uint8_t *frame, size_t len) {
+    if (s->mode == WIRE_BINARY) {
+        session_send(s, (const char *)frame, len);
+        return;
+    }
+    char text[PROTO_TEXT_MAX];
+    size_t n = proto_to_text((const ProtoHeader *)frame, text, sizeof(text));
+    if (n > 0) session_send(s, text, n);
+}
+
+static void session_round(Session *s, RoundEvent event, int arg) {
+    uint8_t frame[PROTO_MAX_FRAME];
+    session_frame(s, frame, proto_round(frame, event, arg));
+}
+
+// --- 2. GAME MESSAGES (same protocol as handle_client) ---
+
+// Text clients always get the full STATE line; binary ones only what changed
+static void send_state(Session *s, const TableSnapshot *snap) {
+    uint8_t frame[PROTO_MAX_FRAME];
+    size_t len = s->mode == WIRE_BINARY ? proto_state_update(frame, &s->view, snap, s->seat)
+                                        : proto_state(frame, snap, s->seat);
+    if (len > 0) session_frame(s, frame, len);
+    stats_since(STAT_FIRST_STATE, s->accepted_ns);
+    stats_since(STAT_ACTION_STATE, s->action_ns);
+    s->accepted_ns = s->action_ns = 0;
+}
+
+// Send STATE, then either the action prompt or the waiting notice
+static void show_turn(Session *s) {
+    GameState *gs = s->gs;
+    TableSnapshot snap;
+    table_snapshot(gs, &snap);
+    const PlayerState *p = &snap.players[s->seat];
+
+    send_state(s, &snap);
+    if (snap.current_turn != s->seat) {
+        session_round(s, EV_NOT_YOUR_TURN, s->seat);
+        s->state = SESS_IN_TURN;
+    } else if (!p->standing && !hand_busted(p)) {
+        uint32_t seq = atomic_load(&gs->turn_seq);
+        if (seq != s->prompted_seq) {
+            stats_since(STAT_TURN_HANDOFF, atomic_load(&gs->turn_started_ns));
+            s->prompted_seq = seq;
+        }
+        odds_sync(s->odds, &gs->shoe);
+        session_round(s, EV_YOUR_TURN, odds_bust_permille(s->odds, p->hard_total));
+        s->state = SESS_AWAITING_ACTION;
+    } else {
+        // Standing/busted seat: reactor_sync() passes the turn on
+        s->state = SESS_IN_TURN;
+    }
+}
+
+static void deal_in(GameState *gs, int seat) {
+    PlayerState *p = &gs->players[seat];
+    table_write_begin(gs);
+    reset_player_state(p);
+    add_card(p, draw_card(gs));
+    add_card(p, draw_card(gs));
+    table_write_end(gs);
+    log_card_dealt(seat, p->cards[0]);
+    log_card_dealt(seat, p->cards[1]);
+}
+
+// --- 3. SEAT MANAGEMENT ---
+
+// Starts serving a player seated at one of this worker's tables
+static void adopt_client(Reactor *r, int fd, GameState *gs, int my_id, uint64_t accepted_ns) {
+    table_write_begin(gs);
+    reset_player_state(&gs->players[my_id]);
+    table_write_end(gs);
+
+    Session *s = calloc(1, sizeof(Session));
+    if (!s) {
+        release_seat(gs, my_id);
+        close(fd);
+        return;
+    }
+    conn_init(&s->conn, fd, capture_send, capture_recv);
+    s->gs = gs;
+    s->odds = &r->odds[gs->table_id - r->range->first];
+    s->seat = my_id;
+    s->state = SESS_HELLO;
+    s->mode = WIRE_TEXT;
+    s->hello_due = tw_now_ms() + PROTO_HELLO_WINDOW_MS;
+    s->accepted_ns = accepted_ns;
+    push_deadline(r, &r->hellos, gs, s->hello_due);
+
+    struct epoll_event ev = { .events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, .data.ptr = s };
+    if (epoll_ctl(r->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        perror("[REACTOR] epoll_ctl failed");
+        release_seat(gs, my_id);
+        close(fd);
+        free(s);
+        return;
+    }
+    table_seats(r, gs)[my_id] = s;
+    mark_dirty(r, gs);
+    capture_conn_open(fd);
+    stats_count(CTR_ACCEPTED);
+
+    printf("[SERVER] Table %d: Player %d connected. Total: %d\n",
+           gs->table_id, my_id, gs->connected_count);
+    log_player_connect(my_id);
+}
+
+// Passes an open socket, with a Handoff, over a Unix datagram socket
+static int send_fd(int chan, int fd, const Handoff *msg) {
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov = { .iov_base = (void *)msg, .iov_len = sizeof(*msg) };
+    struct msghdr mh = {
+        .msg_iov = &iov, .msg_iovlen = 1,
+        .msg_control = control, .msg_controllen = sizeof(control),
+    };
+    memset(control, 0, sizeof(control));
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&mh);
+    cm->cmsg_level = SOL_SOCKET;
+    cm->cmsg_type = SCM_RIGHTS;
+    cm->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cm), &fd, sizeof(int));
+
+    ssize_t n;
+    do {
+        n = sendmsg(chan, &mh, MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+    return n == (ssize_t)sizeof(*msg) ? 0 : -1;
+}
+
+// Message bytes, or -1 with errno set; *fd is -1 if no socket came with it
+static ssize_t recv_fd(int chan, int *fd, Handoff *msg) {
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov = { .iov_base = msg, .iov_len = sizeof(*msg) };
+    struct msghdr mh = {
+        .msg_iov = &iov, .msg_iovlen = 1,
+        .msg_control = control, .msg_controllen = sizeof(control),
+    };
+    ssize_t n = recvmsg(chan, &mh, MSG_CMSG_CLOEXEC);
+    if (n < 0) return -1;
+
+    *fd = -1;
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&mh);
+    if (cm && cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS) {
+        memcpy(fd, CMSG_DATA(cm), sizeof(int));
+    }
+    return n;
+}
+
+/**
+ * The seat claimed for this connection is at another worker's table, and
+ * only that worker's loop may drive the table: pass the socket over.
+ */
+static void hand_off(Reactor *r, int fd, GameState *gs, int my_id, uint64_t accepted_ns) {
+    Handoff msg = { gs->table_id, my_id, accepted_ns };
+    if (send_fd(r->handoff[gs->worker_id][1], fd, &msg) < 0) {
+        perror("[REACTOR] handoff failed");
+        release_seat(gs, my_id);
+        stats_count(CTR_REFUSED);
+    }
+    close(fd);
+}
+
+static void accept_clients(Reactor *r) {
+    while (1) {
+        int fd = accept4(r->listen_sock, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) perror("[REACTOR] accept failed");
+            return;
+        }
+        uint64_t accepted_ns = stats_now();
+
+        // Route the connection to a table with a free seat, at any worker
+        GameState *gs = NULL;
+        int my_id = claim_seat(r->range->dir, &gs);
+        if (my_id == -1) {
+            const char *full = "MESSAGE: All tables are full. Try again later.\n";
+            send(fd, full, strlen(full), MSG_NOSIGNAL);
+            close(fd);
+            stats_count(CTR_REFUSED);
+            continue;
+        }
+        if (gs->worker_id != r->range->worker_id) {
+            hand_off(r, fd, gs, my_id, accepted_ns);
+        } else {
+            adopt_client(r, fd, gs, my_id, accepted_ns);
+        }
+    }
+}
+
+// Connections other workers seated at this worker's tables
+static void receive_handoffs(Reactor *r) {
+    int chan = r->handoff[r->range->worker_id][0];
+    while (1) {
+        Handoff msg;
+        int fd;
+        ssize_t n = recv_fd(chan, &fd, &msg);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) perror("[REACTOR] handoff receive failed");
+            return;
+        }
+
+        // The sender already claimed the seat: any rejection gives it back
+        GameState *gs = n == (ssize_t)sizeof(msg) ? get_table(r->range->dir, msg.table) : NULL;
+        bool seated = gs && msg.seat >= 0 && msg.seat < MAX_PLAYERS;
+        if (!seated || fd < 0 || gs->worker_id != r->range->worker_id) {
+            if (seated) release_seat(gs, msg.seat);
+            if (fd >= 0) close(fd);
+            stats_count(CTR_REFUSED);
+            continue;
+        }
+        adopt_client(r, fd, gs, msg.seat, msg.accepted_ns);
+    }
+}
+
+// Negotiation is over: greet the player in the protocol they chose
+static void greet_session(Session *s, WireMode mode) {
+    s->mode = mode;
+    s->state = SESS_WAITING_PLAYERS;
+    session_round(s, EV_WAITING_PLAYERS, 0);
+}
+
+/**
+ * A session in SESS_HELLO received its first bytes. A leading NUL can only
+ * start a binary hello; anything else is a text client typing early.
+ */
+static void finish_hello(Session *s) {
+    size_t avail;
+    const uint8_t *in = (const uint8_t *)conn_data(&s->conn, &avail);
+    if (avail == 0) return;
+    if (in[0] != 0) {
+        greet_session(s, WIRE_TEXT);
+        return;
+    }
+
+    const ProtoHeader *hello;
+    int len = proto_next_frame(in, avail, &hello);
+    if (len == 0) return; // Rest of the hello still in flight
+    if (len < 0 || !proto_is_hello(hello)) {
+        s->state = SESS_CLOSING;
+        return;
+    }
+    conn_consume(&s->conn, (size_t)len);
+
+    uint8_t frame[PROTO_MAX_FRAME];
+    s->mode = WIRE_BINARY;
+    session_send(s, (const char *)frame, proto_hello_ack(frame, s->seat, s->gs->table_id));
+    greet_session(s, WIRE_BINARY);
+}
+
+static void close_session(Reactor *r, Session *s) {
+    GameState *gs = s->gs;
+
+    // Player is leaving: free the seat and decrease connected count
+    release_seat(gs, s->seat);
+    mark_dirty(r, gs);
+
+    printf("[SERVER] Table %d: Player %d disconnected. Remaining players: %d\n",
+           gs->table_id, s->seat, gs->connected_count);
+    log_player_disconnect(s->seat);
+    stats_count(CTR_DISCONNECTED);
+
+    // Last words (LEAVING, GAME_ENDING) are still queued
+    conn_flush(&s->conn);
+    epoll_ctl(r->epfd, EPOLL_CTL_DEL, s->conn.fd, NULL);
+    capture_conn_close(s->conn.fd);
+    close(s->conn.fd);
+    table_seats(r, gs)[s->seat] = NULL;
+    conn_free(&s->conn);
+    free(s);
+}
+
+// --- 4. INPUT HANDLING ---
+
+static void handle_action(Session *s, int action) {
+    GameState *gs = s->gs;
+    PlayerState *p = &gs->players[s->seat];
+
+    switch (s->state) {
+    case SESS_AWAITING_ACTION:
+        if (action == ACT_HIT) {
+            table_write_begin(gs);
+            add_card(p, draw_card(gs));
+            // A bust or a full hand ends the turn
+            if (hand_busted(p) || p->card_count == MAX_CARDS) {
+                p->standing = true;
+            }
+            table_write_end(gs);
+            log_card_dealt(s->seat, p->cards[p->card_count - 1]);
+            log_player_action(s->seat, "hit", p->points);
+        } else if (action == ACT_STAND) {
+            p->standing = true;
+            log_player_action(s->seat, "stand", p->points);
+        }
+        if (action == ACT_HIT || action == ACT_STAND) {
+            s->action_ns = stats_now();
+            stats_count(CTR_ACTIONS);
+        }
+
+        // --- MEMBER 4: DYNAMIC TURN SWITCHING ---
+        advance_turn(gs);
+        if (gs->game_over) {
+            s->state = SESS_IN_TURN; // reactor_sync() sends the summary
+            s->action_ns = 0;        // ...with no turn STATE to time
+        } else {
+            show_turn(s);
+        }
+        break;
+
+    case SESS_CONTINUE_VOTE:
+        if (action == ACT_CONTINUE) {
+            gs->players[s->seat].connected = true;
+            session_round(s, EV_WAITING_VOTES, 0);
+            s->state = SESS_ROUND_OVER;
+        } else {
+            session_round(s, EV_LEAVING, s->seat);
+            gs->players[s->seat].connected = false;
+            s->state = SESS_CLOSING;
+        }
+        break;
+
+    default:
+        // Input outside a prompt is ignored, as it was never read before
+        break;
+    }
+}
+
+// Text protocol: dispatch every complete line; the partial tail stays
+// buffered (a line longer than the buffer is treated as one command)
+static void consume_lines(Session *s) {
+    char line[CONN_IN_MAX];
+    while (s->state != SESS_CLOSING && conn_line(&s->conn, line, sizeof(line))) {
+        handle_action(s, proto_parse_text(line));
+    }
+}
+
+// Binary protocol: decode frames in place; keep a partial frame
+static void consume_frames(Session *s) {
+    while (s->state != SESS_CLOSING) {
+        size_t avail;
+        const uint8_t *in = (const uint8_t *)conn_data(&s->conn, &avail);
+        const ProtoHeader *hdr;
+        int len = proto_next_frame(in, avail, &hdr);
+        if (len == 0) break;
+        if (len < 0) {
+            s->state = SESS_CLOSING; // Out of sync with the peer
+            return;
+        }
+        if (hdr->type == MSG_ACTION) {
+            handle_action(s, ((const ProtoActionMsg *)proto_payload(hdr))->action);
+        } else if (hdr->type == MSG_RESYNC) {
+            TableSnapshot snap;
+            table_snapshot(s->gs, &snap);
+            s->view.valid = false;
+            send_state(s, &snap);
+        }
+        conn_consume(&s->conn, (size_t)len);
+    }
+}
+
+static void handle_readable(Session *s) {
+    while (s->state != SESS_CLOSING) {
+        ssize_t n = conn_fill(&s->conn);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        if (n <= 0) {
+            s->state = SESS_CLOSING;
+            return;
+        }
+
+        if (s->state == SESS_HELLO) {
+            finish_hello(s);
+            if (s->state == SESS_HELLO) continue;
+        }
+        if (s->mode == WIRE_BINARY) {
+            consume_frames(s);
+        } else {
+            consume_lines(s);
+        }
+    }
+}
+
+// --- 5. TABLE RECONCILIATION ---
+
+static void start_round(Reactor *r, GameState *gs) {
+    Session **seats = table_seats(r, gs);
+
+    reset_game_round(gs);
+    printf("[REACTOR] Table %d: Starting Round %d\n", gs->table_id, gs->round_number);
+
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        Session *s = seats[i];
+        if (!s || s->state == SESS_CLOSING) continue;
+        session_round(s, EV_ROUND_START, gs->round_number);
+        show_turn(s);
+    }
+}
+
+/**
+ * Bring every session in line with the shared table. Called after each batch
+ * of socket events and on every tick, so changes made by the scheduler thread
+ * (timeouts, forced stands, winner) reach the players without polling loops.
+ */
+static void reactor_sync(Reactor *r, GameState *gs) {
+    Session **seats = table_seats(r, gs);
+    bool round_running = gs->round_number > 0 && !gs->game_over;
+
+    // Silent through the whole hello window: a text client
+    uint64_t now_ms = tw_now_ms();
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        Session *s = seats[i];
+        if (s && s->state == SESS_HELLO && now_ms >= s->hello_due) {
+            greet_session(s, WIRE_TEXT);
+        }
+    }
+
+    if (round_running && gs->connected_count == 0) {
+        // Everyone left mid-round: close it without a winner
+        gs->game_over = true;
+        round_running = false;
+    }
+
+    if (round_running) {
+        // Late joiners are dealt straight into the running round
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            Session *s = seats[i];
+            if (s && s->state == SESS_WAITING_PLAYERS && gs->connected_count >= 2) {
+                deal_in(gs, i);
+                session_round(s, EV_ROUND_START, gs->round_number);
+                show_turn(s);
+            }
+        }
+
+        // Pass over seats that cannot act (left, standing, busted)
+        for (int guard = 0; guard <= MAX_PLAYERS && !gs->game_over; guard++) {
+            int cur = gs->current_turn;
+            Session *s = seats[cur];
+            PlayerState *p = &gs->players[cur];
+            if (s && s->state == SESS_AWAITING_ACTION) break;
+            if (s && s->state == SESS_IN_TURN && !p->standing && !hand_busted(p)) {
+                show_turn(s);
+                break;
+            }
+            advance_turn(gs);
+        }
+
+        // Prompts overtaken by a scheduler timeout
+        for (int i = 0; i < MAX_PLAYERS && !gs->game_over; i++) {
+            Session *s = seats[i];
+            if (s && s->state == SESS_AWAITING_ACTION && gs->current_turn != i) {
+                show_turn(s);
+            }
+        }
+    }
+
+    if (gs->round_number > 0 && gs->game_over) {
+        // --- GAME OVER SUMMARY ---
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            Session *s = seats[i];
+            if (!s || (s->state != SESS_IN_TURN && s->state != SESS_AWAITING_ACTION)) continue;
+
+            if (gs->winner == -1) {
+                determine_winner(gs);
+            }
+            TableSnapshot snap;
+            table_snapshot(gs, &snap);
+            int winner = snap.winner;
+            if (winner != -1) {
+                uint8_t frame[PROTO_MAX_FRAME];
+                session_frame(s, frame, proto_result(frame, winner, snap.players[winner].points));
+            }
+            session_round(s, EV_CONTINUE_VOTE, 0);
+            s->state = SESS_CONTINUE_VOTE;
+            s->vote_started = time(NULL);
+            push_deadline(r, &r->votes, gs, now_ms + (VOTE_TIMEOUT + 1) * 1000);
+        }
+    }
+
+    // Resolve the continue vote once nobody is still deciding
+    int deciding = 0, continuing = 0, voted_yes = 0;
+    time_t now = time(NULL);
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        Session *s = seats[i];
+        if (!s) continue;
+        if (s->state == SESS_CONTINUE_VOTE && now - s->vote_started > VOTE_TIMEOUT) {
+            session_round(s, EV_LEAVING, i);
+            gs->players[i].connected = false;
+            s->state = SESS_CLOSING;
+        }
+        if (s->state == SESS_CONTINUE_VOTE) deciding++;
+        if (s->state == SESS_ROUND_OVER) voted_yes++;
+        if (s->state == SESS_ROUND_OVER || s->state == SESS_WAITING_PLAYERS) continuing++;
+    }
+
+    if (deciding > 0 || (gs->round_number > 0 && !gs->game_over)) return;
+
+    if (continuing >= 2) {
+        start_round(r, gs);
+    } else if (voted_yes > 0) {
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            Session *s = seats[i];
+            if (s && s->state == SESS_ROUND_OVER) {
+                session_round(s, EV_GAME_ENDING, 0);
+                s->state = SESS_CLOSING;
+            }
+        }
+    }
+}
+
+static void reap_closed(Reactor *r, GameState *gs) {
+    Session **seats = table_seats(r, gs);
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        Session *s = seats[i];
+        if (s && s->state == SESS_CLOSING) {
+            close_session(r, s);
+        }
+    }
+}
+
+// Everything this loop turn queued for a seat goes out in one send()
+static void flush_table(Reactor *r, GameState *gs) {
+    Session **seats = table_seats(r, gs);
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        Session *s = seats[i];
+        if (s && conn_pending(&s->conn) > 0) session_flush(s);
+    }
+}
+
+static void sync_table(Reactor *r, GameState *gs) {
+    reap_closed(r, gs);
+    reactor_sync(r, gs);
+    flush_table(r, gs);
+    reap_closed(r, gs);
+}
+
+// --- 6. EVENT LOOP ---
+
+int run_reactor(int listen_sock, int watch_sock, TableRange *range, int (*handoff)[2]) {
+    GameState *tables = &range->dir->tables[range->first];
+    Reactor r;
+    memset(&r, 0, sizeof(r));
+    r.listen_sock = listen_sock;
+    r.range = range;
+    r.handoff = handoff;
+    r.seats = calloc((size_t)range->count * MAX_PLAYERS, sizeof(Session *));
+    r.dirty = calloc(range->count, sizeof(bool));
+    r.dirty_list = calloc(range->count, sizeof(int));
+    r.pending = calloc(range->count, sizeof(bool));
+    r.pending_list = calloc(range->count, sizeof(int));
+    r.odds = calloc(range->count, sizeof(ShoeCounts));
+    if (!r.seats || !r.dirty || !r.dirty_list || !r.pending || !r.pending_list || !r.odds) {
+        perror("[ERROR] Reactor allocation failed");
+        return -1;
+    }
+
+    raise_fd_limit();
+    if (set_nonblocking(listen_sock) < 0) {
+        perror("[ERROR] Failed to make listener non-blocking");
+        return -1;
+    }
+
+    r.epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (r.epfd < 0) {
+        perror("[ERROR] epoll_create1 failed");
+        return -1;
+    }
+
+    // data.ptr == NULL marks the listening socket
+    struct epoll_event lev = { .events = EPOLLIN | EPOLLET, .data.ptr = NULL };
+    if (epoll_ctl(r.epfd, EPOLL_CTL_ADD, listen_sock, &lev) < 0) {
+        perror("[ERROR] epoll_ctl listener failed");
+        close(r.epfd);
+        return -1;
+    }
+
+    // Wakeups from the scheduler thread arrive through an eventfd
+    r.notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event nev = { .events = EPOLLIN | EPOLLET, .data.ptr = &notify_marker };
+    if (r.notify_fd < 0 || epoll_ctl(r.epfd, EPOLL_CTL_ADD, r.notify_fd, &nev) < 0) {
+        perror("[ERROR] eventfd setup failed");
+        close(r.epfd);
+        return -1;
+    }
+
+    // Watchers live on the hub's own epoll instance, polled here as one fd
+    r.spectators = spectator_hub_create(watch_sock, range->dir);
+    struct epoll_event sev = { .events = EPOLLIN, .data.ptr = &spectator_marker };
+    if (!r.spectators ||
+        epoll_ctl(r.epfd, EPOLL_CTL_ADD, spectator_hub_fd(r.spectators), &sev) < 0) {
+        perror("[ERROR] Spectator hub setup failed");
+        spectator_hub_destroy(r.spectators);
+        close(r.notify_fd);
+        close(r.epfd);
+        return -1;
+    }
+
+    // Players other workers seated at these tables are passed over here
+    int handoff_in = handoff[range->worker_id][0];
+    struct epoll_event hev = { .events = EPOLLIN | EPOLLET, .data.ptr = &handoff_marker };
+    if (set_nonblocking(handoff_in) < 0 || epoll_ctl(r.epfd, EPOLL_CTL_ADD, handoff_in, &hev) < 0) {
+        perror("[ERROR] Handoff socket setup failed");
+        spectator_hub_destroy(r.spectators);
+        close(r.notify_fd);
+        close(r.epfd);
+        return -1;
+    }
+    pthread_mutex_init(&r.pending_lock, NULL);
+    r.loop_thread = pthread_self();
+    active_reactor = &r;
+    table_notify_hook = reactor_notify;
+
+    // Anything the scheduler did before the hook was installed
+    for (int t = 0; t < range->count; t++) {
+        if (tables[t].connected_count > 0) mark_dirty(&r, &tables[t]);
+    }
+
+    printf("[REACTOR] Event loop running (edge-triggered epoll).\n");
+
+    struct epoll_event events[MAX_EVENTS];
+    int timeout_ms = -1;
+
+    while (1) {
+        int n = epoll_wait(r.epfd, events, MAX_EVENTS, timeout_ms);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("[ERROR] epoll_wait failed");
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            Session *s = events[i].data.ptr;
+            if (s == NULL) {
+                accept_clients(&r);
+                continue;
+            }
+            if (events[i].data.ptr == &notify_marker) {
+                drain_notifications(&r);
+                continue;
+            }
+            if (events[i].data.ptr == &spectator_marker) {
+                spectator_hub_dispatch(r.spectators);
+                continue;
+            }
+            if (events[i].data.ptr == &handoff_marker) {
+                receive_handoffs(&r);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                session_flush(s);
+            }
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                handle_readable(s);
+            }
+            mark_dirty(&r, s->gs);
+        }
+
+        // Only tables touched by this batch, by the scheduler, or with an
+        // expired vote are visited; idle tables cost nothing
+        expire_all(&r);
+        while (r.dirty_count > 0) {
+            int t = r.dirty_list[--r.dirty_count];
+            r.dirty[t] = false;
+            sync_table(&r, &tables[t]);
+        }
+        timeout_ms = expire_all(&r);
+
+        // Watchers get the tables' newest frames once per tick
+        int tick_ms = spectator_hub_tick(r.spectators);
+        if (tick_ms >= 0 && (timeout_ms < 0 || tick_ms < timeout_ms)) timeout_ms = tick_ms;
+    }
+
+    table_notify_hook = NULL;
+    active_reactor = NULL;
+    spectator_hub_destroy(r.spectators);
+    close(r.notify_fd);
+    close(r.epfd);
+    free(r.seats);
+    free(r.dirty);
+    free(r.dirty_list);
+    free(r.pending);
+    free(r.pending_list);
+    free(r.odds);
+    free(r.votes.items);
+    free(r.hellos.items);
+    return -1;
+}
@@ -0,0 +1,61 @@
+// src/rules.c
+#include <string.h>
+#include "rules.h"
+
+const uint8_t card_value[14] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 10, 10, 10};
+
+int calculate_points(const int *cards, int count) {
+    int points = 0, aces = 0;
+    for (int i = 0; i < count; i++) {
+        int val = cards[i];
+        if (val == 1) { aces++; points += 11; }
+        else if (val >= 10) { points += 10; }
+        else { points += val; }
+    }
+    while (points > 21 && aces > 0) { points -= 10; aces--; }
+    return points;
+}
+
+bool add_card(PlayerState *p, int card) {
+    if (p->card_count >= MAX_CARDS) return false;
+
+    p->cards[p->card_count++] = card;
+    p->hard_total += card_value[card];
+    p->aces += (card == 1);
+    p->points = hand_total(p->hard_total, p->aces);
+    return true;
+}
+
+void reset_player_state(PlayerState *p) {
+    p->card_count = 0;
+    p->points = 0;
+    p->hard_total = 0;
+    p->aces = 0;
+    p->standing = false;
+    memset(p->cards, 0, sizeof(p->cards));
+}
+
+int pick_winner(const PlayerState *players, int count) {
+    int max_points = -1;
+    int winner = -1;
+
+    for (int i = 0; i < count; i++) {
+        if (players[i].connected && 
+            !hand_busted(&players[i]) && 
+            players[i].points > max_points) {
+            max_points = players[i].points;
+            winner = i;
+        }
+    }
+    
+    // Also check if all players busted
+    if (winner == -1) {
+        for (int i = 0; i < count; i++) {
+            if (players[i].connected) {
+                winner = i;  
+                break;
+            }
+        }
+    }
+    return winner;
+}
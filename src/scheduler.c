@@ -6,19 +6,54 @@
 #include <stdbool.h>
 #include <time.h>
 #include "game_state.h"
+#include "shared_mem.h"
+#include "timer_wheel.h"
+#include "rules.h"
+#include "lock_profile.h"
+#include "logger.h"
+#include "strategy.h"
 
 // Forward declarations of functions in game_logic.c
 extern void reset_game_round(GameState *gs);
 extern void determine_winner(GameState *gs);
+extern int draw_card(GameState *gs);
 
 #define TURN_DURATION 20 // 20 seconds timeout
+#define TURN_TIMEOUT_MS (TURN_DURATION * 1000)
 
+// Scheduler-local timer state for one worker's tables
+typedef struct {
+    TableRange *range;
+    TimerWheel wheel;
+    TimerNode *timers;      // One turn timer per table in the range
+    uint32_t *armed_seq;    // turn_seq each timer was armed for
+} SchedulerCtx;
+
+/**
+ * A seat that let its turn run out is played for it: basic strategy
+ * (strategy.h) from its current cards to the end of its turn, one table
+ * lookup per card, then it stands.
+ */
 void handle_turn_timeout(GameState* gs, int player_id) {
     PlayerState *p = &gs->players[player_id];
-    if (p->active && !p->standing) {
-        printf("[SCHEDULER] Timeout for Player %d. Forcing STAND.\n", player_id);
-        p->standing = true;
+    if (!p->active || p->standing) return;
+
+    int drawn = 0;
+    table_write_begin(gs);
+    while (!hand_busted(p) && p->card_count < MAX_CARDS &&
+           strategy_seat_hits(gs->players, MAX_PLAYERS, player_id)) {
+        add_card(p, draw_card(gs));
+        drawn++;
+    }
+    p->standing = true;
+    table_write_end(gs);
+
+    printf("[SCHEDULER] Table %d: Timeout for Player %d. Autoplayed %d card(s) to %d points.\n",
+           gs->table_id, player_id, drawn, p->points);
+    for (int i = p->card_count - drawn; i < p->card_count; i++) {
+        log_card_dealt(player_id, p->cards[i]);
     }
+    log_player_action(player_id, "auto", p->points);
 }
 
 // Helper to find next player
@@ -31,7 +66,7 @@ int find_next_active_player(GameState* gs, int current) {
         loops++;
         
         PlayerState *np = &gs->players[next];
-        if (np->active && np->connected && !np->standing && np->points <= 21) {
+        if (np->active && np->connected && !np->standing && !hand_busted(np)) {
             return next;
         }
     } while (loops < MAX_PLAYERS);
@@ -39,75 +74,141 @@ int find_next_active_player(GameState* gs, int current) {
     return -1; // No active players found
 }
 
-void* scheduler_thread_func(void* arg) {
-    GameState *gs = (GameState*)arg;
-    printf("[SCHEDULER] Thread started. Waiting for game to begin...\n");
+/**
+ * Called with turn_sem held. Forces STAND on a timed-out seat, then passes
+ * the turn on from a seat that cannot act (busted, standing, disconnected).
+ * Returns true if current_turn moved.
+ */
+static bool pass_turn_locked(GameState *gs, bool timed_out) {
+    int current = gs->current_turn;
+    PlayerState *p = &gs->players[current];
+    
+    bool need_pass_turn = false;
+    
+    // 1. Check for Timeout
+    if (timed_out) {
+        handle_turn_timeout(gs, current);
+        need_pass_turn = true;
+    }
 
-    while (1) {
-        // Wait for game to be active
-        if (!gs->game_active) {
-            usleep(100000); // 100ms
-            continue;
-        }
+    // 2. Check status (Busted, Standing, Disconnected)
+    if (!p->active || !p->connected) {
+        need_pass_turn = true;
+        printf("[SCHEDULER] Table %d: Player %d inactive/disconnected. Passing turn.\n", gs->table_id, current);
+    }
+    else if (p->standing) {
+        need_pass_turn = true;
+    }
+    else if (hand_busted(p)) {
+         need_pass_turn = true;
+         p->standing = true;
+         printf("[SCHEDULER] Table %d: Player %d busted. Passing turn.\n", gs->table_id, current);
+    }
+    
+    // 3. Pass Turn if needed
+    if (need_pass_turn) {
+        int next = find_next_active_player(gs, current);
         
-        if (gs->game_over) {
-             printf("[SCHEDULER] Game Over. Waiting for new round...\n");
-             usleep(500000);
-             continue;
+        if (next != -1) {
+            table_write_begin(gs);
+            gs->current_turn = next;
+            gs->players[next].last_active = time(NULL);
+            table_write_end(gs);
+            printf("[SCHEDULER] Table %d: Turn passed to Player %d\n", gs->table_id, next);
+            return true;
         }
 
-        // Lock to check state (using &gs->turn_sem as per Black_Jack-main struct)
-        sem_wait(&gs->turn_sem);
-        
-        int current = gs->current_turn;
-        PlayerState *p = &gs->players[current];
-        
-        bool need_pass_turn = false;
-        
-        // 1. Check for Timeout
-        time_t now = time(NULL);
-        if (p->last_active == 0) {
-            p->last_active = now; // Initialize if fresh
-        }
-        
-        if (now - p->last_active > TURN_DURATION) {
-            handle_turn_timeout(gs, current);
-            need_pass_turn = true;
-        }
+        // No one left to play
+        printf("[SCHEDULER] Table %d: All players done. Determining winner.\n", gs->table_id);
+        determine_winner(gs);
+    }
+    return false;
+}
 
-        // 2. Check status (Busted, Standing, Disconnected)
-        if (!p->active || !p->connected) {
-            need_pass_turn = true;
-            printf("[SCHEDULER] Player %d inactive/disconnected. Passing turn.\n", current);
-        }
-        else if (p->standing) {
-            need_pass_turn = true;
-        }
-        else if (p->points > 21) {
-             need_pass_turn = true;
-             p->standing = true;
-             printf("[SCHEDULER] Player %d busted. Passing turn.\n", current);
-        }
-        
-        // 3. Pass Turn if needed
-        if (need_pass_turn) {
-            int next = find_next_active_player(gs, current);
-            
-            if (next != -1) {
-                gs->current_turn = next;
-                gs->players[next].last_active = time(NULL); // Reset timer for new player
-                printf("[SCHEDULER] Turn passed to Player %d\n", next);
-            } else {
-                // No one left to play
-                 printf("[SCHEDULER] All players done. Determining winner.\n");
-                 // Note: determine_winner should be defined or extracted from handle_client in game_logic.c
-                 determine_winner(gs);
-            }
+/**
+ * A table in this worker's range changed. Pass the turn on if the current
+ * seat cannot act, otherwise arm one deadline per turn handoff.
+ */
+static void schedule_table(SchedulerCtx *ctx, int t) {
+    GameState *gs = &ctx->range->dir->tables[ctx->range->first + t];
+    TimerNode *timer = &ctx->timers[t];
+
+    // Wait for game to be active
+    if (!gs->game_active || gs->game_over) {
+        tw_cancel(&ctx->wheel, timer);
+        return;
+    }
+
+    // Lock to check state (using &gs->turn_sem as per Black_Jack-main struct)
+    TABLE_LOCK(gs, LOCK_TURN);
+    bool passed = pass_turn_locked(gs, false);
+    TABLE_UNLOCK(gs, LOCK_TURN);
+
+    if (passed) {
+        notify_turn(gs); // Requeues the table; the new seat is armed then
+        return;
+    }
+
+    uint32_t seq = atomic_load(&gs->turn_seq);
+    if (gs->game_over) {
+        tw_cancel(&ctx->wheel, timer);
+    } else if (!timer->armed || ctx->armed_seq[t] != seq) {
+        ctx->armed_seq[t] = seq;
+        tw_arm(&ctx->wheel, timer, tw_now_ms() + TURN_TIMEOUT_MS);
+    }
+}
+
+// Timer wheel callback: only tables whose deadline really expired get here
+static void on_turn_timeout(TimerNode *node, void *arg) {
+    SchedulerCtx *ctx = arg;
+    int t = (int)(node - ctx->timers);
+    GameState *gs = &ctx->range->dir->tables[ctx->range->first + t];
+
+    if (!gs->game_active || gs->game_over) return;
+    if (atomic_load(&gs->turn_seq) != ctx->armed_seq[t]) return; // Handoff already queued
+
+    TABLE_LOCK(gs, LOCK_TURN);
+    bool passed = pass_turn_locked(gs, true);
+    TABLE_UNLOCK(gs, LOCK_TURN);
+
+    if (passed) {
+        notify_turn(gs);
+    }
+}
+
+void* scheduler_thread_func(void* arg) {
+    TableRange *range = (TableRange*)arg;
+    TableDirectory *dir = range->dir;
+    WaitQueue *wq = &dir->worker_wq[range->worker_id];
+
+    SchedulerCtx ctx;
+    ctx.range = range;
+    ctx.timers = calloc(range->count, sizeof(TimerNode));
+    ctx.armed_seq = calloc(range->count, sizeof(uint32_t));
+    if (!ctx.timers || !ctx.armed_seq) {
+        perror("[ERROR] Scheduler allocation failed");
+        return NULL;
+    }
+    tw_init(&ctx.wheel, tw_now_ms());
+
+    printf("[SCHEDULER] Thread started for tables %d-%d. Waiting for games to begin...\n",
+           range->first, range->first + range->count - 1);
+
+    while (1) {
+        // Snapshot before draining so a change made meanwhile is not missed
+        uint32_t seen = wq_prepare(wq);
+
+        // Only tables that changed are visited...
+        int table;
+        while ((table = pop_table_event(dir, range->worker_id)) >= 0) {
+            schedule_table(&ctx, table - range->first);
         }
-        
-        sem_post(&gs->turn_sem);
-        
-        usleep(100000); // 100ms slice
+
+        // ...and only deadlines that expired fire
+        tw_advance(&ctx.wheel, tw_now_ms(), on_turn_timeout, &ctx);
+
+        // Sleep until the next deadline, or forever when no turn is running
+        wq_wait(wq, seen, tw_timeout_ms(&ctx.wheel, tw_now_ms()));
     }
     return NULL;
 }
@@ -1,19 +1,205 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "game_state.h"
+#include "scores.h"
 
-void init_score_system() {
-    printf("[SYS] Score system initialized.\n");
+// Inherited by every forked process; NULL until a file is mapped
+static ScoreFile *scores = NULL;
+static size_t scores_size = 0;
+
+static size_t file_size(uint32_t capacity) {
+    return sizeof(ScoreFile) + (size_t)capacity * sizeof(ScoreRecord);
+}
+
+static int map_score_file(const char *path, bool writable, uint32_t capacity) {
+    int fd = open(path, writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (fd == -1) {
+        perror("[ERROR] Score file open failed");
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        perror("[ERROR] Score file stat failed");
+        close(fd);
+        return -1;
+    }
+
+    // Reuse an existing file's layout; a new or too small one is (re)sized.
+    // Records are indexed by table and seat, so growing keeps them in place.
+    ScoreFile header;
+    bool existing = (size_t)st.st_size >= sizeof(ScoreFile) &&
+                    pread(fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header) &&
+                    header.magic == SCORES_MAGIC && header.version == SCORES_VERSION &&
+                    (size_t)st.st_size >= file_size(header.capacity);
+    if (!existing && !writable) {
+        fprintf(stderr, "[ERROR] %s is not a score file\n", path);
+        close(fd);
+        return -1;
+    }
+    if (existing && header.capacity > capacity) capacity = header.capacity;
+    if (writable && (!existing || header.capacity < capacity)) {
+        if (!existing && ftruncate(fd, 0) == -1) {
+            perror("[ERROR] Score file truncate failed");
+            close(fd);
+            return -1;
+        }
+        if (ftruncate(fd, (off_t)file_size(capacity)) == -1) {
+            perror("[ERROR] Score file resize failed");
+            close(fd);
+            return -1;
+        }
+    }
+
+    size_t size = file_size(capacity);
+    ScoreFile *file = mmap(NULL, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (file == MAP_FAILED) {
+        perror("[ERROR] Score file mmap failed");
+        return -1;
+    }
+
+    if (writable) {
+        if (!existing) {
+            file->magic = SCORES_MAGIC;
+            file->version = SCORES_VERSION;
+        }
+        file->capacity = capacity;
+        // A server killed mid-update may have left these taken
+        atomic_store(&file->top_lock, 0);
+        atomic_store(&file->top_seq, atomic_load(&file->top_seq) & ~1u);
+    }
+    scores = file;
+    scores_size = size;
+    return 0;
+}
+
+int init_score_system(int table_count) {
+    if (map_score_file(SCORES_FILE, true, (uint32_t)table_count * MAX_PLAYERS) != 0) return -1;
+    printf("[SYS] Score system initialized (%s, %u seats).\n", SCORES_FILE, scores->capacity);
+    return 0;
+}
+
+int attach_score_file(const char *path) {
+    return map_score_file(path, false, 0);
 }
 
 void shutdown_score_system() {
+    if (scores == NULL) return;
+    msync(scores, scores_size, MS_SYNC);
+    munmap(scores, scores_size);
+    scores = NULL;
     printf("[SYS] Score system shutting down... scores saved.\n");
 }
 
-void update_score(int player_id, int score) {
-    FILE *f = fopen("scores.txt", "a");
-    if (f) {
-        fprintf(f, "Player %d: %d\n", player_id, score);
-        fclose(f);
+static void lock_top(ScoreFile *file) {
+    uint32_t expected = 0;
+    while (!atomic_compare_exchange_weak(&file->top_lock, &expected, 1)) {
+        expected = 0;
+        sched_yield();
+    }
+}
+
+static void unlock_top(ScoreFile *file) {
+    atomic_store(&file->top_lock, 0);
+}
+
+static uint64_t record_wins(ScoreFile *file, int32_t rec) {
+    return atomic_load_explicit(&file->records[rec].wins, memory_order_relaxed);
+}
+
+// rec just won: move it up (or into) the top-N list, insertion-sort style
+static void update_top(ScoreFile *file, int32_t rec, uint64_t wins) {
+    // Cheap reject without the lock: not listed and no better than the last
+    uint32_t count = atomic_load(&file->top_count);
+    if (count == SCORES_TOP_N) {
+        bool listed = false;
+        for (uint32_t i = 0; i < count && !listed; i++) listed = atomic_load(&file->top[i]) == rec;
+        if (!listed && wins <= record_wins(file, atomic_load(&file->top[count - 1]))) return;
+    }
+
+    lock_top(file);
+    atomic_fetch_add(&file->top_seq, 1);
+
+    count = atomic_load(&file->top_count);
+    uint32_t pos = 0;
+    while (pos < count && atomic_load(&file->top[pos]) != rec) pos++;
+    if (pos == count) {
+        if (count < SCORES_TOP_N) {
+            atomic_store(&file->top_count, ++count);
+        } else {
+            pos = count - 1;
+            if (wins <= record_wins(file, atomic_load(&file->top[pos]))) pos = count; // Lost a race
+        }
+        if (pos < count) atomic_store(&file->top[pos], rec);
+    }
+    while (pos > 0 && pos < count &&
+           record_wins(file, atomic_load(&file->top[pos - 1])) < wins) {
+        atomic_store(&file->top[pos], atomic_load(&file->top[pos - 1]));
+        atomic_store(&file->top[pos - 1], rec);
+        pos--;
+    }
+
+    atomic_fetch_add(&file->top_seq, 1);
+    unlock_top(file);
+}
+
+void update_score(int table_id, int seat, bool won, int points) {
+    ScoreFile *file = scores;
+    if (file == NULL || seat < 0 || seat >= MAX_PLAYERS) return;
+    int32_t rec = table_id * MAX_PLAYERS + seat;
+    if (table_id < 0 || (uint32_t)rec >= file->capacity) return;
+
+    ScoreRecord *r = &file->records[rec];
+    atomic_fetch_add_explicit(&r->rounds, 1, memory_order_relaxed);
+    if (points > 0) atomic_fetch_add_explicit(&r->points, (uint64_t)points, memory_order_relaxed);
+    if (won) {
+        uint64_t wins = atomic_fetch_add_explicit(&r->wins, 1, memory_order_relaxed) + 1;
+        update_top(file, rec, wins);
     }
-}
\ No newline at end of file
+}
+
+static void copy_entry(ScoreFile *file, int32_t rec, ScoreEntry *out) {
+    ScoreRecord *r = &file->records[rec];
+    out->table_id = rec / MAX_PLAYERS;
+    out->seat = rec % MAX_PLAYERS;
+    out->wins = atomic_load_explicit(&r->wins, memory_order_relaxed);
+    out->rounds = atomic_load_explicit(&r->rounds, memory_order_relaxed);
+    out->points = atomic_load_explicit(&r->points, memory_order_relaxed);
+}
+
+bool score_lookup(int table_id, int seat, ScoreEntry *out) {
+    ScoreFile *file = scores;
+    if (file == NULL || table_id < 0 || seat < 0 || seat >= MAX_PLAYERS) return false;
+    int32_t rec = table_id * MAX_PLAYERS + seat;
+    if ((uint32_t)rec >= file->capacity) return false;
+    copy_entry(file, rec, out);
+    return out->rounds > 0;
+}
+
+int score_top(ScoreEntry *out, int n) {
+    ScoreFile *file = scores;
+    if (file == NULL || n <= 0) return 0;
+    if (n > SCORES_TOP_N) n = SCORES_TOP_N;
+
+    int32_t top[SCORES_TOP_N];
+    uint32_t count, seq;
+    do {
+        while ((seq = atomic_load(&file->top_seq)) & 1u) sched_yield();
+        count = atomic_load(&file->top_count);
+        if (count > SCORES_TOP_N) count = SCORES_TOP_N;
+        for (uint32_t i = 0; i < count; i++) top[i] = atomic_load(&file->top[i]);
+    } while (atomic_load(&file->top_seq) != seq);
+
+    int stored = 0;
+    for (uint32_t i = 0; i < count && stored < n; i++) {
+        if (top[i] < 0 || (uint32_t)top[i] >= file->capacity) continue;
+        copy_entry(file, top[i], &out[stored++]);
+    }
+    return stored;
+}
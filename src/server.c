@@ -1,98 +1,398 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
 #include <signal.h>
 #include <pthread.h>
+#include <time.h>
+#include <sys/wait.h>
+#include <poll.h>
 #include "game_state.h"
 #include "shared_mem.h"
+#include "reactor.h"
+#include "logger.h"
+#include "shuffler.h"
+#include "capture.h"
+#include "stats.h"
+#include "lock_profile.h"
+#include "scores.h"
+#include "spectator.h"
+
+#define DEFAULT_BACKLOG 128
 
 // Global pointer for the signal handler to access
-GameState *gs = NULL;
+TableDirectory *dir = NULL;
+
+// Worker processes, so the master can stop them on shutdown
+static pid_t *worker_pids = NULL;
+static int worker_count = 0;
+
+// Each worker's share of the tables, split before forking
+static TableRange *ranges = NULL;
+
+// Reactor mode: one socketpair per worker, for players another worker
+// seated at its tables (run_reactor())
+static int (*handoff)[2] = NULL;
+
+typedef struct {
+    bool reactor_mode;
+    int table_count;
+    int workers;
+    int backlog;
+    LogFullPolicy log_policy;
+    ShoeConfig shoe;
+    const char *capture_path;
+} ServerConfig;
 
 // Forward declaration of client handler
-void handle_client(int sock, int id, GameState *gs);
+void handle_client(int sock, int id, GameState *gs, uint64_t accepted_ns);
 
 void handle_signal(int sig) {
     (void)sig;
     printf("\n[SERVER] Shutting down...\n");
-    if (gs != NULL) cleanup_shared_memory(gs);
+    for (int w = 0; w < worker_count; w++) {
+        if (worker_pids[w] > 0) kill(worker_pids[w], SIGTERM);
+    }
+    // Let the workers go before draining the last log records they queued
+    for (int w = 0; w < worker_count; w++) {
+        if (worker_pids[w] > 0) waitpid(worker_pids[w], NULL, 0);
+    }
+    stop_shuffler();
+    lockprof_report();
+    capture_close();
+    shutdown_score_system();
+    shutdown_stats();
+    shutdown_logger();
+    if (dir != NULL) cleanup_shared_memory(dir);
     exit(0);
 }
 
-int main() {
-    int server_sock, new_socket;
+static void print_usage(const char *prog) {
+    printf("Usage: %s [--reactor] [--tables N] [--workers N] [--backlog N] [--log-policy drop|block]\n"
+           "          [--decks N] [--penetration P] [--seed N] [--capture FILE]\n", prog);
+    printf("  --reactor    Serve clients from one epoll event loop per worker instead of fork()\n");
+    printf("  --tables N   Number of tables in shared memory (default %d, max %d)\n",
+           DEFAULT_TABLES, MAX_TABLES);
+    printf("  --workers N  Pre-forked accept workers (default one per core, max %d)\n", MAX_WORKERS);
+    printf("  --backlog N  listen() backlog of each worker (default %d)\n", DEFAULT_BACKLOG);
+    printf("  --log-policy drop|block\n");
+    printf("               What a full log ring does to the caller (default block)\n");
+    printf("  --decks N    Decks per table shoe (default %d, max %d)\n", DEFAULT_DECKS, MAX_DECKS);
+    printf("  --penetration P\n");
+    printf("               Percent of the shoe dealt before reshuffling (default %d)\n",
+           DEFAULT_PENETRATION);
+    printf("  --seed N     Shuffle seed; the same seed deals the same shoes (default: clock)\n");
+    printf("  --capture FILE\n");
+    printf("               Record all client traffic with timestamps, for bjreplay\n");
+}
+
+/**
+ * Each worker binds its own socket to the port with SO_REUSEPORT, so the
+ * kernel spreads incoming connections across workers (and cores).
+ */
+static int create_listener(int port, int backlog) {
     struct sockaddr_in address;
-    socklen_t addrlen = sizeof(address);
+    int server_sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (server_sock < 0) {
+        perror("[ERROR] socket failed");
+        return -1;
+    }
 
-    signal(SIGINT, handle_signal);
+    int opt = 1;
+    setsockopt(server_sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    if (setsockopt(server_sock, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        perror("[ERROR] SO_REUSEPORT failed");
+        close(server_sock);
+        return -1;
+    }
 
-    // Initialize Shared Memory
-    gs = setup_shared_memory();
-    if (!gs) exit(1);
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(port);
+
+    if (bind(server_sock, (struct sockaddr *)&address, sizeof(address)) < 0) {
+        perror("Bind failed");
+        close(server_sock);
+        return -1;
+    }
+
+    if (listen(server_sock, backlog) < 0) {
+        perror("[ERROR] listen failed");
+        close(server_sock);
+        return -1;
+    }
+    return server_sock;
+}
+
+static void run_worker(TableRange *range, const ServerConfig *cfg) {
+    int new_socket;
+    int worker_id = range->worker_id;
 
-    // Initialize game structure once in parent
-    init_game_state_struct(gs);
-    gs->connected_count = 0; // Ensure counter starts at zero
-    gs->game_over = false;
+    // Ctrl-C reaches the whole process group; only the master cleans up
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
 
-    // Start Scheduler Thread
+    int server_sock = create_listener(8888, cfg->backlog);
+    if (server_sock < 0) exit(1);
+    // Spectators are optional: without their port the game still runs
+    int watch_sock = create_listener(SPECTATOR_PORT, cfg->backlog);
+    if (watch_sock < 0) {
+        fprintf(stderr, "[WARN] Worker %d: spectator port %d unavailable, running without spectators\n",
+                worker_id, SPECTATOR_PORT);
+    }
+
+    // Start Scheduler Thread for this worker's tables
     pthread_t sched_tid;
     extern void* scheduler_thread_func(void* arg);
-    if (pthread_create(&sched_tid, NULL, scheduler_thread_func, (void*)gs) != 0) {
+    if (pthread_create(&sched_tid, NULL, scheduler_thread_func, (void*)range) != 0) {
         perror("[ERROR] Failed to create scheduler thread");
     }
     pthread_detach(sched_tid);
 
-    server_sock = socket(AF_INET, SOCK_STREAM, 0);
-    int opt = 1;
-    setsockopt(server_sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-
-    address.sin_family = AF_INET;
-    address.sin_addr.s_addr = INADDR_ANY;
-    address.sin_port = htons(8888);
+    printf("[WORKER %d] Ready on port 8888 (spectators %d), tables %d-%d (pid %d)\n",
+           worker_id, SPECTATOR_PORT, range->first, range->first + range->count - 1, getpid());
 
-    if (bind(server_sock, (struct sockaddr *)&address, sizeof(address)) < 0) {
-        perror("Bind failed");
+    if (cfg->reactor_mode) {
+        run_reactor(server_sock, watch_sock, range, handoff);
         exit(1);
     }
 
-    listen(server_sock, 5);
-    printf("Blackjack Server ready for PvP on port 8888...\n");
+    // Client processes are reaped automatically
+    signal(SIGCHLD, SIG_IGN);
 
+    struct pollfd listeners[2] = {
+        { .fd = server_sock, .events = POLLIN },
+        { .fd = watch_sock, .events = POLLIN },
+    };
     while (1) {
-        new_socket = accept(server_sock, (struct sockaddr *)&address, &addrlen);
+        if (poll(listeners, 2, -1) < 0) continue;
+
+        // Spectators get a process each too, and never take a seat
+        if (listeners[1].revents & POLLIN) {
+            int watcher = accept(watch_sock, NULL, NULL);
+            if (watcher >= 0) {
+                if (fork() == 0) {
+                    close(server_sock);
+                    close(watch_sock);
+                    handle_spectator(watcher, dir);
+                    exit(0);
+                }
+                close(watcher);
+            }
+        }
+        if (!(listeners[0].revents & POLLIN)) continue;
+
+        new_socket = accept(server_sock, NULL, NULL);
         if (new_socket < 0) continue;
+        uint64_t accepted_ns = stats_now();
 
-        // MEMBER 4: Locking the count update
-        sem_wait(&gs->score_sem);
-        int my_id = gs->connected_count;
-        if (my_id < MAX_PLAYERS) {
-            gs->connected_count++;
-            // Initialize player state in parent to avoid race condition with scheduler
-            gs->players[my_id].player_id = my_id;
-            gs->players[my_id].connected = true;
-            gs->players[my_id].active = true;
-            gs->players[my_id].last_active = time(NULL);
+        // Route the connection to a table with a free seat, at any worker:
+        // the child serves it directly, and the owning worker's scheduler
+        // times its turns
+        GameState *gs = NULL;
+        int my_id = claim_seat(dir, &gs);
+        if (my_id == -1) {
+            const char *full = "MESSAGE: All tables are full. Try again later.\n";
+            send(new_socket, full, strlen(full), MSG_NOSIGNAL);
+            close(new_socket);
+            stats_count(CTR_REFUSED);
+            continue;
         }
-        sem_post(&gs->score_sem);
+        stats_count(CTR_ACCEPTED);
 
-        printf("[SERVER] Player %d connected. Total: %d\n", my_id, gs->connected_count);
+        printf("[SERVER] Table %d: Player %d connected. Total: %d\n",
+               gs->table_id, my_id, gs->connected_count);
+        log_player_connect(my_id);
 
         if (fork() == 0) { // Child Process
             close(server_sock);
-            handle_client(new_socket, my_id, gs);
+            if (watch_sock >= 0) close(watch_sock);
+            handle_client(new_socket, my_id, gs, accepted_ns);
             exit(0);
         }
         
         close(new_socket);
-        
-        // Optional: Reset count if you want to start a new game after 2 players
-        if (gs->connected_count >= 2) {
-             // Logic to handle more players or stop accepting can go here
+    }
+}
+
+int main(int argc, char *argv[]) {
+    ServerConfig cfg = {
+        .reactor_mode = false,
+        .table_count = DEFAULT_TABLES,
+        .workers = (int)sysconf(_SC_NPROCESSORS_ONLN),
+        .backlog = DEFAULT_BACKLOG,
+        .log_policy = LOG_FULL_BLOCK,
+        .shoe = {
+            .decks = DEFAULT_DECKS,
+            .penetration = DEFAULT_PENETRATION,
+            .seed = (uint64_t)time(NULL) ^ ((uint64_t)getpid() << 32),
+        },
+    };
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--reactor") == 0) {
+            cfg.reactor_mode = true;
+        } else if (strcmp(argv[i], "--tables") == 0 && i + 1 < argc) {
+            cfg.table_count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            cfg.workers = atoi(argv[++i]);
+            if (cfg.workers > MAX_WORKERS) {
+                print_usage(argv[0]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--backlog") == 0 && i + 1 < argc) {
+            cfg.backlog = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--log-policy") == 0 && i + 1 < argc) {
+            const char *policy = argv[++i];
+            if (strcmp(policy, "drop") == 0) {
+                cfg.log_policy = LOG_FULL_DROP;
+            } else if (strcmp(policy, "block") == 0) {
+                cfg.log_policy = LOG_FULL_BLOCK;
+            } else {
+                print_usage(argv[0]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--decks") == 0 && i + 1 < argc) {
+            cfg.shoe.decks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--penetration") == 0 && i + 1 < argc) {
+            cfg.shoe.penetration = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            cfg.shoe.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            cfg.capture_path = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            exit(1);
+        }
+    }
+    // The directory has one wait queue and event ring per worker
+    if (cfg.workers > MAX_WORKERS) cfg.workers = MAX_WORKERS;
+    if (cfg.workers < 1) cfg.workers = 1;
+    if (cfg.workers > cfg.table_count) cfg.workers = cfg.table_count;
+    if (cfg.backlog < 1) cfg.backlog = DEFAULT_BACKLOG;
+    if (cfg.shoe.decks < 1 || cfg.shoe.decks > MAX_DECKS ||
+        cfg.shoe.penetration < 10 || cfg.shoe.penetration > 100) {
+        print_usage(argv[0]);
+        exit(1);
+    }
+
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+
+    // Initialize Shared Memory
+    dir = setup_shared_memory(cfg.table_count);
+    if (!dir) exit(1);
+
+    // Workers inherit the log ring; the flusher thread stays in the master
+    if (init_logger(cfg.log_policy) != 0) {
+        cleanup_shared_memory(dir);
+        exit(1);
+    }
+
+    // Initialize every table once in parent; each shoe gets its own stream
+    for (int t = 0; t < dir->table_count; t++) {
+        GameState *gs = get_table(dir, t);
+        init_game_state_struct(gs, &cfg.shoe);
+        gs->connected_count = 0; // Ensure counter starts at zero
+        gs->game_over = false;
+    }
+
+    // Spares are refilled off the dealing path from here on
+    if (start_shuffler(dir) != 0) {
+        shutdown_logger();
+        cleanup_shared_memory(dir);
+        exit(1);
+    }
+
+    // Opened before the fork so every worker appends to the same file
+    if (cfg.capture_path && capture_open(cfg.capture_path, &cfg.shoe) != 0) {
+        stop_shuffler();
+        shutdown_logger();
+        cleanup_shared_memory(dir);
+        exit(1);
+    }
+
+    // Leaderboard file, mapped once and shared by every worker
+    if (init_score_system(dir->table_count) != 0) {
+        fprintf(stderr, "[WARN] Scores will not be recorded\n");
+    }
+
+    // Latency histograms for bjstat; the server runs fine without them
+    if (init_stats() != 0) {
+        fprintf(stderr, "[WARN] Stats segment unavailable, bjstat will have nothing to show\n");
+    }
+
+    // Only with LOCK_PROFILE=1: shared counters for every TABLE_LOCK() site
+    if (lockprof_init(dir->table_count) != 0) {
+        fprintf(stderr, "[WARN] Lock profiling unavailable\n");
+    }
+
+    // Pre-fork the accept workers
+    worker_pids = calloc(cfg.workers, sizeof(pid_t));
+    ranges = calloc(cfg.workers, sizeof(TableRange));
+    if (!worker_pids || !ranges) exit(1);
+    split_tables(dir, cfg.workers, ranges);
+    if (cfg.reactor_mode) {
+        handoff = calloc(cfg.workers, sizeof(*handoff));
+        if (!handoff) exit(1);
+        for (int w = 0; w < cfg.workers; w++) {
+            if (socketpair(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0, handoff[w]) < 0) {
+                perror("[ERROR] Handoff socketpair failed");
+                exit(1);
+            }
+        }
+    }
+    fflush(stdout);
+    for (int w = 0; w < cfg.workers; w++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            run_worker(&ranges[w], &cfg);
+            exit(0);
+        }
+        if (pid < 0) {
+            perror("[ERROR] Failed to fork worker");
+            continue;
+        }
+        worker_pids[w] = pid;
+        worker_count = w + 1;
+    }
+
+    printf("Blackjack Server ready for PvP on port 8888 (%d tables, %d workers, backlog %d)...\n",
+           dir->table_count, cfg.workers, cfg.backlog);
+    printf("Shoe: %d deck(s), %d%% penetration, seed %llu\n",
+           cfg.shoe.decks, cfg.shoe.penetration, (unsigned long long)cfg.shoe.seed);
+
+    // The master only supervises: wait until every worker has exited
+    int running = 0;
+    for (int w = 0; w < worker_count; w++) {
+        if (worker_pids[w] > 0) running++;
+    }
+    while (running > 0) {
+        int status;
+        pid_t pid = wait(&status);
+        if (pid < 0 && errno == EINTR) {
+            lockprof_poll();
+            continue;
+        }
+        if (pid < 0) break;
+        for (int w = 0; w < worker_count; w++) {
+            if (worker_pids[w] == pid) {
+                printf("[SERVER] Worker %d (pid %d) exited.\n", w, pid);
+                worker_pids[w] = 0;
+                running--;
+            }
         }
     }
+
+    lockprof_report();
+    capture_close();
+    shutdown_score_system();
+    shutdown_stats();
+    shutdown_logger();
+    cleanup_shared_memory(dir);
     return 0;
-}
\ No newline at end of file
+}
@@ -1,16 +1,37 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <sys/mman.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <stddef.h>
 #include <semaphore.h>
+#include <sched.h>
 #include "shared_mem.h"
+#include "stats.h"
+#include "lock_profile.h"
+
+// Size of the mapping, kept for munmap()
+static size_t shm_size = 0;
+
+void (*table_notify_hook)(GameState *gs) = NULL;
+
+static size_t directory_size(int table_count) {
+    return sizeof(TableDirectory) + (size_t)table_count * sizeof(GameState);
+}
 
 /**
- * Creates and maps a shared memory segment for the GameState.
+ * Creates and maps a shared memory segment holding the table directory.
  * Also initializes all semaphores for process synchronization.
  */
-GameState* setup_shared_memory() {
+TableDirectory* setup_shared_memory(int table_count) {
+    if (table_count < 1 || table_count > MAX_TABLES) {
+        fprintf(stderr, "[ERROR] Table count must be between 1 and %d\n", MAX_TABLES);
+        return NULL;
+    }
+    size_t size = directory_size(table_count);
+
     // 1. Open (or create) the shared memory object
     int shm_fd = shm_open("/blackjack_shm", O_CREAT | O_RDWR, 0666);
     if (shm_fd == -1) {
@@ -19,54 +40,63 @@ GameState* setup_shared_memory() {
     }
 
     // 2. Set the size of the shared memory segment
-    if (ftruncate(shm_fd, sizeof(GameState)) == -1) {
+    if (ftruncate(shm_fd, size) == -1) {
         perror("[ERROR] ftruncate failed");
         close(shm_fd);
         return NULL;
     }
 
     // 3. Map the segment into this process's memory space
-    GameState *gs = mmap(NULL, sizeof(GameState), 
-                         PROT_READ | PROT_WRITE, 
-                         MAP_SHARED, shm_fd, 0);
-    
-    if (gs == MAP_FAILED) {
+    TableDirectory *dir = mmap(NULL, size,
+                               PROT_READ | PROT_WRITE,
+                               MAP_SHARED, shm_fd, 0);
+
+    if (dir == MAP_FAILED) {
         perror("[ERROR] mmap failed");
         close(shm_fd);
         return NULL;
     }
+    shm_size = size;
+
+    // A segment left behind by a crashed run may hold stale tables
+    memset(dir, 0, size);
+    dir->table_count = table_count;
 
     // --- MEMBER 4 SYNCHRONIZATION INITIALIZATION ---
-    // All semaphores use '1' as the second argument to indicate 
+    // All semaphores use '1' as the second argument to indicate
     // they are shared across processes (POSIX requirement).
 
-    // Protects the deck and card drawing
-    sem_init(&gs->deck_mutex, 1, 1); 
+    for (int t = 0; t < table_count; t++) {
+        GameState *gs = &dir->tables[t];
+        gs->table_id = t;
 
-    // Used to manage player turns (initialized to 0 if used for blocking)
-    sem_init(&gs->turn_sem, 1, 1); 
+        // Used to manage player turns (initialized to 0 if used for blocking)
+        sem_init(&gs->turn_sem, 1, 1);
 
-    // Protects score updates and winner calculation
-    sem_init(&gs->score_sem, 1, 1); 
+        // Protects score updates and winner calculation
+        sem_init(&gs->score_sem, 1, 1);
+    }
 
     // File descriptor is no longer needed after mapping
     close(shm_fd);
-    return gs;
+    return dir;
 }
 
 /**
  * Unmaps the shared memory and removes the object from the system.
  */
-void cleanup_shared_memory(GameState *gs) {
-    if (gs != NULL) {
+void cleanup_shared_memory(TableDirectory *dir) {
+    if (dir != NULL) {
         // Destroy all semaphores to release system resources
-        sem_destroy(&gs->deck_mutex);
-        sem_destroy(&gs->turn_sem);
-        sem_destroy(&gs->score_sem);
-        
+        for (int t = 0; t < dir->table_count; t++) {
+            GameState *gs = &dir->tables[t];
+            sem_destroy(&gs->turn_sem);
+            sem_destroy(&gs->score_sem);
+        }
+
         // Unmap the memory from the current process
-        munmap(gs, sizeof(GameState));
-        
+        munmap(dir, shm_size);
+
         // Remove the named shared memory object
         if (shm_unlink("/blackjack_shm") == 0) {
             printf("[INFO] Shared memory and all semaphores cleaned up.\n");
@@ -74,4 +104,226 @@ void cleanup_shared_memory(GameState *gs) {
             perror("[WARNING] shm_unlink failed");
         }
     }
-}
\ No newline at end of file
+}
+
+GameState* get_table(TableDirectory *dir, int idx) {
+    if (idx < 0 || idx >= dir->table_count) return NULL;
+    return &dir->tables[idx];
+}
+
+/**
+ * Gives every worker an even, contiguous share of the tables, filling in
+ * ranges[0..workers-1]. Run once by the master before it forks: any worker
+ * may seat a player at any table and route its events to the owner, so
+ * every table's owner and every event ring must be in place before the
+ * first worker starts.
+ */
+void split_tables(TableDirectory *dir, int workers, TableRange *ranges) {
+    int base = dir->table_count / workers;
+    int extra = dir->table_count % workers;
+
+    for (int w = 0; w < workers; w++) {
+        TableRange *range = &ranges[w];
+        range->dir = dir;
+        range->worker_id = w;
+        range->first = w * base + (w < extra ? w : extra);
+        range->count = base + (w < extra ? 1 : 0);
+
+        TableEventRing *ring = &dir->worker_ring[w];
+        ring->first = range->first;
+        ring->count = range->count;
+        atomic_store(&ring->head, 0);
+        atomic_store(&ring->tail, 0);
+
+        for (int t = range->first; t < range->first + range->count; t++) {
+            dir->tables[t].worker_id = w;
+        }
+    }
+}
+
+/**
+ * Routes a new connection to a table with a free seat, in any worker's
+ * range. Next-fit from the directory's shared open_hint keeps filling the
+ * table that already has players waiting, whichever worker accepted them,
+ * so games start as soon as two people arrive.
+ * Returns the seat and stores the table in *table, or -1 if all are full.
+ */
+int claim_seat(TableDirectory *dir, GameState **table) {
+    int seat = -1;
+    int hint = atomic_load_explicit(&dir->open_hint, memory_order_relaxed);
+
+    for (int n = 0; n < dir->table_count && seat == -1; n++) {
+        int t = (hint + n) % dir->table_count;
+        GameState *gs = &dir->tables[t];
+        if (gs->connected_count >= MAX_PLAYERS) continue;
+
+        // MEMBER 4: Locking the count update
+        TABLE_LOCK(gs, LOCK_SCORE);
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            PlayerState *p = &gs->players[i];
+            // A seat stays taken until its handler has fully left (active)
+            if (!p->connected && !p->active) {
+                table_write_begin(gs);
+                gs->connected_count++;
+                p->player_id = i;
+                p->connected = true;
+                p->active = true;
+                p->last_active = time(NULL);
+                table_write_end(gs);
+                seat = i;
+                break;
+            }
+        }
+        TABLE_UNLOCK(gs, LOCK_SCORE);
+
+        if (seat != -1) {
+            atomic_store_explicit(&dir->open_hint, t, memory_order_relaxed);
+            *table = gs;
+            notify_table(gs);
+        }
+    }
+
+    return seat;
+}
+
+/**
+ * Gives a seat back to its table once the player's handler is done with it.
+ */
+void release_seat(GameState *gs, int seat) {
+    TABLE_LOCK(gs, LOCK_SCORE);
+    table_write_begin(gs);
+    gs->players[seat].connected = false;
+    gs->players[seat].active = false;
+    if (gs->connected_count > 0) {
+        gs->connected_count--;
+    }
+    table_write_end(gs);
+    TABLE_UNLOCK(gs, LOCK_SCORE);
+    notify_table(gs);
+}
+
+/**
+ * Enters the table's write section: moves seq from even to odd. A writer
+ * that finds it odd waits for the other one to leave.
+ */
+void table_write_begin(GameState *gs) {
+    uint32_t seq = atomic_load_explicit(&gs->seq, memory_order_relaxed);
+    for (;;) {
+        if (seq & 1u) {
+            sched_yield();
+            seq = atomic_load_explicit(&gs->seq, memory_order_relaxed);
+            continue;
+        }
+        if (atomic_compare_exchange_weak_explicit(&gs->seq, &seq, seq + 1,
+                                                  memory_order_acquire, memory_order_relaxed)) {
+            break;
+        }
+    }
+    // Readers that see any of the writes below also see seq odd
+    atomic_thread_fence(memory_order_release);
+}
+
+void table_write_end(GameState *gs) {
+    atomic_fetch_add_explicit(&gs->seq, 1, memory_order_release);
+}
+
+/**
+ * Copies the game state without taking any lock. A copy overlapping a
+ * write section is thrown away and taken again.
+ */
+void table_snapshot(const GameState *gs, TableSnapshot *out) {
+    for (int tries = 0;; tries++) {
+        uint32_t before = atomic_load_explicit(&gs->seq, memory_order_acquire);
+        if ((before & 1u) == 0) {
+            memcpy(out->players, gs->players, sizeof(out->players));
+            out->current_turn = gs->current_turn;
+            out->connected_count = gs->connected_count;
+            out->game_active = gs->game_active;
+            out->game_over = gs->game_over;
+            out->winner = gs->winner;
+            out->round_number = gs->round_number;
+            out->state_version = atomic_load_explicit(&gs->state_version, memory_order_relaxed);
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&gs->seq, memory_order_relaxed) == before) {
+                out->seq = before;
+                return;
+            }
+        }
+        if (tries >= 64) sched_yield();
+    }
+}
+
+/**
+ * Recovers the directory from one of its tables (tables[] is the last member).
+ */
+TableDirectory* table_directory(GameState *gs) {
+    GameState *first = gs - gs->table_id;
+    return (TableDirectory *)((char *)first - offsetof(TableDirectory, tables));
+}
+
+// Hand the table to its worker's scheduler (at most once until drained)
+static void queue_table_event(TableDirectory *dir, GameState *gs) {
+    if (atomic_exchange(&gs->sched_pending, 1)) return;
+
+    TableEventRing *ring = &dir->worker_ring[gs->worker_id];
+    if (ring->count == 0) {
+        atomic_store(&gs->sched_pending, 0);
+        return;
+    }
+    uint32_t pos = atomic_fetch_add(&ring->tail, 1);
+    GameState *slot = &dir->tables[ring->first + pos % (uint32_t)ring->count];
+    atomic_store_explicit(&slot->event_slot, gs->table_id + 1, memory_order_release);
+}
+
+int pop_table_event(TableDirectory *dir, int worker_id) {
+    TableEventRing *ring = &dir->worker_ring[worker_id];
+    if (ring->count == 0) return -1;
+
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    GameState *slot = &dir->tables[ring->first + head % (uint32_t)ring->count];
+    int value = atomic_load_explicit(&slot->event_slot, memory_order_acquire);
+    if (value == 0) return -1;  // Empty, or a producer is mid-publish
+
+    atomic_store_explicit(&slot->event_slot, 0, memory_order_relaxed);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    // Cleared before the table is read, so later changes queue it again
+    atomic_store(&dir->tables[value - 1].sched_pending, 0);
+    return value - 1;
+}
+
+/**
+ * The turn moved: wake only the seat that now has to act, plus the
+ * scheduler that owns the table, which arms a fresh turn deadline.
+ */
+void notify_turn(GameState *gs) {
+    TableDirectory *dir = table_directory(gs);
+    atomic_store(&gs->turn_started_ns, stats_now());
+    atomic_fetch_add(&gs->turn_seq, 1);
+    atomic_fetch_add(&gs->state_version, 1);
+
+    int turn = gs->current_turn;
+    if (turn >= 0 && turn < MAX_PLAYERS) {
+        wq_wake_all(&gs->seat_wq[turn]);
+    }
+    queue_table_event(dir, gs);
+    wq_wake_all(&dir->worker_wq[gs->worker_id]);
+    if (table_notify_hook) table_notify_hook(gs);
+}
+
+/**
+ * Something every seat cares about changed (round start, game over,
+ * players joining or leaving): wake the whole table.
+ */
+void notify_table(GameState *gs) {
+    TableDirectory *dir = table_directory(gs);
+    atomic_fetch_add(&gs->state_version, 1);
+
+    wq_wake_all(&gs->table_wq);
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        wq_wake_all(&gs->seat_wq[i]);
+    }
+    queue_table_event(dir, gs);
+    wq_wake_all(&dir->worker_wq[gs->worker_id]);
+    if (table_notify_hook) table_notify_hook(gs);
+}
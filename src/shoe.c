@@ -0,0 +1,106 @@
+// src/shoe.c
+#include <sched.h>
+#include "shoe.h"
+#include "rules.h"
+
+void (*shoe_spare_hook)(Shoe *shoe) = NULL;
+
+void shuffle_cards(uint8_t *cards, int n, Rng *rng) {
+    for (int i = n - 1; i > 0; i--) {
+        int j = (int)rng_below(rng, (uint32_t)i + 1);
+        uint8_t tmp = cards[i];
+        cards[i] = cards[j];
+        cards[j] = tmp;
+    }
+}
+
+// Every card of every deck, in order, then shuffled
+static void fresh_shoe(Shoe *shoe, uint8_t *cards) {
+    int idx = 0;
+    for (int d = 0; d < shoe->size / DECK_SIZE; d++) {
+        for (int s = 0; s < 4; s++) {
+            for (int v = 1; v <= 13; v++) {
+                cards[idx++] = (uint8_t)v;
+            }
+        }
+    }
+    shuffle_cards(cards, shoe->size, &shoe->rng);
+}
+
+static uint32_t current_gen(Shoe *shoe) {
+    return SHOE_GEN(atomic_load_explicit(&shoe->cursor, memory_order_acquire));
+}
+
+bool shoe_fill_spare(Shoe *shoe) {
+    int expect = SPARE_EMPTY;
+    if (!atomic_compare_exchange_strong_explicit(&shoe->spare, &expect, SPARE_FILLING,
+                                                 memory_order_acquire, memory_order_relaxed)) {
+        return false;
+    }
+    // The generation cannot move on while the spare is not READY
+    fresh_shoe(shoe, shoe->cards[!(current_gen(shoe) & 1)]);
+    atomic_store_explicit(&shoe->spare, SPARE_READY, memory_order_release);
+    return true;
+}
+
+void shoe_retire(Shoe *shoe, int buffer) {
+    atomic_store_explicit(&shoe->taken[buffer], 0, memory_order_relaxed);
+    atomic_store_explicit(&shoe->spare, SPARE_EMPTY, memory_order_release);
+    if (shoe_spare_hook) shoe_spare_hook(shoe);
+}
+
+void shoe_advance(Shoe *shoe, uint32_t gen) {
+    // Win the spare first: whoever holds it in SWAPPING is the only swapper
+    for (;;) {
+        if (current_gen(shoe) != gen) return;
+        int state = atomic_load_explicit(&shoe->spare, memory_order_acquire);
+        if (state == SPARE_READY &&
+            atomic_compare_exchange_weak_explicit(&shoe->spare, &state, SPARE_SWAPPING,
+                                                  memory_order_acquire, memory_order_relaxed)) {
+            break;
+        }
+        if (state == SPARE_EMPTY) {
+            // Shuffler fell behind (or there is none)
+            if (shoe_fill_spare(shoe)) atomic_fetch_add(&shoe->inline_fills, 1);
+        } else if (state != SPARE_READY) {
+            sched_yield();    // Mid-shuffle, mid-swap or still draining: microseconds
+        }
+    }
+    if (current_gen(shoe) != gen) {
+        atomic_store_explicit(&shoe->spare, SPARE_READY, memory_order_release);
+        return;
+    }
+
+    // Draws racing with us land either in the old shoe (counted below) or
+    // in the new one
+    uint64_t old = atomic_exchange_explicit(&shoe->cursor, (uint64_t)(gen + 1) << 32,
+                                            memory_order_acq_rel);
+    uint32_t claimed = SHOE_IDX(old) < (uint32_t)shoe->size ? SHOE_IDX(old) : (uint32_t)shoe->size;
+    atomic_store_explicit(&shoe->spare, SPARE_DRAINING, memory_order_release);
+
+    // Unclaimed cards count as read, plus one for the swap itself
+    shoe_put_back(shoe, gen & 1, (uint32_t)shoe->size - claimed + 1);
+}
+
+void shoe_swap(Shoe *shoe) {
+    shoe_advance(shoe, current_gen(shoe));
+}
+
+void shoe_init(Shoe *shoe, const ShoeConfig *cfg, uint64_t stream) {
+    int decks = cfg->decks < 1 ? 1 : cfg->decks > MAX_DECKS ? MAX_DECKS : cfg->decks;
+
+    shoe->size = decks * DECK_SIZE;
+    // The cut card never leaves less than one round's worth of cards
+    shoe->cut = shoe->size * cfg->penetration / 100;
+    if (shoe->cut > shoe->size - RESHUFFLE_THRESHOLD) {
+        shoe->cut = shoe->size - RESHUFFLE_THRESHOLD;
+    }
+    rng_seed(&shoe->rng, cfg->seed, stream);
+    atomic_store(&shoe->cursor, 0);
+    atomic_store(&shoe->taken[0], 0);
+    atomic_store(&shoe->taken[1], 0);
+    atomic_store(&shoe->inline_fills, 0);
+    fresh_shoe(shoe, shoe->cards[0]);
+    fresh_shoe(shoe, shoe->cards[1]);
+    atomic_store_explicit(&shoe->spare, SPARE_READY, memory_order_release);
+}
@@ -0,0 +1,76 @@
+// src/shuffler.c
+#include <stdio.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "shuffler.h"
+
+static TableDirectory *shuffle_dir = NULL;
+static pthread_t shuffler_tid;
+static pid_t shuffler_owner = 0;
+static _Atomic int stopping;
+
+// Runs in whichever process retired the old shoe. Once per shoe, not per
+// card, so the futex wake stays off the per-card path.
+static void count_swap(Shoe *shoe) {
+    (void)shoe;
+    atomic_fetch_add_explicit(&shuffle_dir->spares_taken, 1, memory_order_release);
+    wq_wake_all(&shuffle_dir->shuffler_wq);
+}
+
+static void* shuffler_thread_func(void *arg) {
+    TableDirectory *dir = arg;
+    uint32_t swept = atomic_load(&dir->spares_taken);
+
+    for (;;) {
+        uint32_t seen = wq_prepare(&dir->shuffler_wq);
+        if (atomic_load(&stopping)) break;
+
+        // Nothing retired since the last sweep: sleep until a shoe is
+        uint32_t taken = atomic_load_explicit(&dir->spares_taken, memory_order_acquire);
+        if (taken == swept) {
+            wq_wait(&dir->shuffler_wq, seen, -1);
+            continue;
+        }
+
+        // A sweep is one CAS per empty spare plus its shuffle
+        swept = taken;
+        for (int t = 0; t < dir->table_count; t++) {
+            shoe_fill_spare(&dir->tables[t].shoe);
+        }
+    }
+    return NULL;
+}
+
+int start_shuffler(TableDirectory *dir) {
+    shuffle_dir = dir;
+    atomic_store(&stopping, 0);
+
+    // Shutdown and report signals must land on the main thread, never on the shuffler
+    sigset_t block, old;
+    sigemptyset(&block);
+    sigaddset(&block, SIGINT);
+    sigaddset(&block, SIGTERM);
+    sigaddset(&block, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+    int rc = pthread_create(&shuffler_tid, NULL, shuffler_thread_func, dir);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (rc != 0) {
+        fprintf(stderr, "[ERROR] Failed to create shuffler thread\n");
+        return -1;
+    }
+
+    shoe_spare_hook = count_swap;
+    shuffler_owner = getpid();
+    return 0;
+}
+
+void stop_shuffler(void) {
+    if (shuffle_dir == NULL || shuffler_owner != getpid()) return;
+
+    atomic_store(&stopping, 1);
+    wq_wake_all(&shuffle_dir->shuffler_wq);
+    pthread_join(shuffler_tid, NULL);
+    shoe_spare_hook = NULL;
+    shuffle_dir = NULL;
+}
@@ -0,0 +1,449 @@
+// src/spectator.c
+// Read-only table feeds (see spectator.h). Frames are rendered into the
+// table's shared TableFrame under its own sequence lock: a process that
+// finds the frame older than the table renders it, everyone else copies.
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <strings.h>
+#include <errno.h>
+#include <sched.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/time.h>
+#include "spectator.h"
+#include "shared_mem.h"
+#include "timer_wheel.h"
+
+#define HUB_EVENTS 256
+#define WATCH_LINE_MAX 64
+#define SPECTATE_SEND_TIMEOUT 30   // Seconds a fork-mode watcher may stall a send
+
+// --- 1. RENDERING ---
+
+static void append(char *out, size_t *n, const char *fmt, ...) {
+    if (*n >= TABLE_FRAME_MAX) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int len = vsnprintf(out + *n, TABLE_FRAME_MAX - *n, fmt, ap);
+    va_end(ap);
+    if (len > 0) *n += (size_t)len;
+    if (*n >= TABLE_FRAME_MAX) *n = TABLE_FRAME_MAX - 1; // Truncated
+}
+
+static size_t render_table(int table_id, const TableSnapshot *snap, char *out) {
+    const char *status = snap->round_number == 0 ? "waiting" : snap->game_over ? "over" : "playing";
+    size_t n = 0;
+
+    append(out, &n, "TABLE: id=%d round=%d version=%u players=%d turn=%d status=%s\n",
+           table_id, snap->round_number, snap->state_version, snap->connected_count,
+           snap->current_turn, status);
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        const PlayerState *p = &snap->players[i];
+        if (!p->connected) continue;
+        append(out, &n, "SEAT: id=%d cards=", i);
+        for (int c = 0; c < p->card_count && c < MAX_CARDS; c++) {
+            append(out, &n, "%d%s", p->cards[c], c == p->card_count - 1 ? "" : ",");
+        }
+        append(out, &n, " points=%d standing=%s\n", p->points, p->standing ? "true" : "false");
+    }
+    if (snap->round_number > 0 && snap->game_over) {
+        if (snap->winner >= 0 && snap->winner < MAX_PLAYERS) {
+            append(out, &n, "RESULT: winner=%d points=%d\n", snap->winner,
+                   snap->players[snap->winner].points);
+        } else {
+            append(out, &n, "RESULT: winner=none\n");
+        }
+    }
+    append(out, &n, "END\n");
+    return n;
+}
+
+size_t spectator_frame(GameState *gs, char *out, uint32_t *version) {
+    TableFrame *f = &gs->frame;
+    uint32_t want = atomic_load(&gs->state_version);
+
+    for (int tries = 0;; tries++) {
+        uint32_t seq = atomic_load_explicit(&f->seq, memory_order_acquire);
+        if (!(seq & 1u)) {
+            uint32_t have = atomic_load_explicit(&f->version, memory_order_relaxed);
+            uint32_t len = atomic_load_explicit(&f->len, memory_order_relaxed);
+            if (len > 0 && (int32_t)(have - want) >= 0) {
+                if (len > TABLE_FRAME_MAX) len = TABLE_FRAME_MAX;
+                memcpy(out, f->data, len);
+                atomic_thread_fence(memory_order_acquire);
+                if (atomic_load_explicit(&f->seq, memory_order_relaxed) == seq) {
+                    *version = have;
+                    return len;
+                }
+                continue;
+            }
+
+            // Out of date: render it here unless another process already is
+            if (atomic_compare_exchange_weak_explicit(&f->seq, &seq, seq + 1,
+                                                      memory_order_acquire, memory_order_relaxed)) {
+                atomic_thread_fence(memory_order_release);
+                TableSnapshot snap;
+                table_snapshot(gs, &snap);
+                size_t n = render_table(gs->table_id, &snap, out);
+                memcpy(f->data, out, n);
+                atomic_store_explicit(&f->len, (uint32_t)n, memory_order_relaxed);
+                atomic_store_explicit(&f->version, snap.state_version, memory_order_relaxed);
+                atomic_store_explicit(&f->seq, seq + 2, memory_order_release);
+                *version = snap.state_version;
+                return n;
+            }
+        }
+        if (tries >= 64) sched_yield();
+    }
+}
+
+int spectator_parse(const char *line, int table_count) {
+    if (strncasecmp(line, "watch", 5) != 0) return -1;
+    char *end;
+    long table = strtol(line + 5, &end, 10);
+    if (end == line + 5 || table < 0 || table >= table_count) return -1;
+    while (*end == ' ' || *end == '\r' || *end == '\n') end++;
+    return *end == '\0' ? (int)table : -1;
+}
+
+static void send_usage(int sock, int table_count) {
+    char msg[128];
+    int len = snprintf(msg, sizeof(msg), "MESSAGE: Usage: watch <table 0-%d>\n", table_count - 1);
+    send(sock, msg, (size_t)len, MSG_NOSIGNAL | MSG_DONTWAIT);
+}
+
+// --- 2. FORK MODE ---
+
+static int send_all(int sock, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(sock, buf, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        buf += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+// Drains anything the watcher typed; true once it hung up
+static bool peer_gone(int sock) {
+    char junk[256];
+    for (;;) {
+        ssize_t n = recv(sock, junk, sizeof(junk), MSG_DONTWAIT);
+        if (n > 0) continue;
+        if (n == 0) return true;
+        return errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR;
+    }
+}
+
+/**
+ * One process per watcher, like handle_client(). It sleeps on the table's
+ * wait queue, and sends the newest frame each time it wakes to a new
+ * version; while a send blocks, the versions in between are skipped.
+ */
+void handle_spectator(int sock, TableDirectory *dir) {
+    struct timeval tv = { SPECTATE_HELLO_MS / 1000, (SPECTATE_HELLO_MS % 1000) * 1000 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    tv = (struct timeval){ SPECTATE_SEND_TIMEOUT, 0 };
+    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    char line[WATCH_LINE_MAX];
+    size_t len = 0;
+    while (len < sizeof(line) - 1 && memchr(line, '\n', len) == NULL) {
+        ssize_t n = recv(sock, line + len, sizeof(line) - 1 - len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            close(sock);
+            return;
+        }
+        len += (size_t)n;
+    }
+    line[len] = '\0';
+
+    int table = spectator_parse(line, dir->table_count);
+    if (table < 0) {
+        send_usage(sock, dir->table_count);
+        close(sock);
+        return;
+    }
+    GameState *gs = get_table(dir, table);
+    printf("[SPECTATOR] Table %d: watcher connected (pid %d)\n", table, getpid());
+
+    char frame[TABLE_FRAME_MAX];
+    uint32_t sent = 0;
+    bool first = true;
+    for (;;) {
+        uint32_t seen = wq_prepare(&gs->table_wq);
+        if (first || atomic_load(&gs->state_version) != sent) {
+            size_t n = spectator_frame(gs, frame, &sent);
+            if (send_all(sock, frame, n) != 0) break;
+            first = false;
+            continue;
+        }
+        // table_wq covers rounds and seating; turns are picked up per tick
+        wq_wait(&gs->table_wq, seen, SPECTATE_TICK_MS);
+        if (peer_gone(sock)) break;
+    }
+    printf("[SPECTATOR] Table %d: watcher left\n", table);
+    close(sock);
+}
+
+// --- 3. REACTOR MODE ---
+
+typedef struct Watcher {
+    int fd;
+    int table;              // -1 until the watch line arrives
+    uint64_t hello_due;
+    bool sent;              // Has been sent a frame of 'version'
+    uint32_t version;
+    bool closing;
+
+    char in[WATCH_LINE_MAX];
+    size_t in_len;
+
+    // What the socket did not take of the last frame; nothing newer is
+    // sent until it drains, and by then only the newest frame is
+    char *tail;
+    size_t tail_len;
+
+    struct Watcher *prev, *next;    // Same table's list, or the pending list
+} Watcher;
+
+struct SpectatorHub {
+    int epfd;
+    int listen_sock;
+    TableDirectory *dir;
+    Watcher **by_table;     // dir->table_count lists
+    Watcher *pending;       // Connected, watch line not in yet
+    int watchers;
+    uint64_t next_tick;
+    char frame[TABLE_FRAME_MAX];   // One copy of a table's frame for all its watchers
+};
+
+static Watcher** watcher_list(SpectatorHub *hub, Watcher *w) {
+    return w->table < 0 ? &hub->pending : &hub->by_table[w->table];
+}
+
+static void link_watcher(SpectatorHub *hub, Watcher *w) {
+    Watcher **head = watcher_list(hub, w);
+    w->prev = NULL;
+    w->next = *head;
+    if (*head) (*head)->prev = w;
+    *head = w;
+}
+
+static void unlink_watcher(SpectatorHub *hub, Watcher *w) {
+    if (w->prev) {
+        w->prev->next = w->next;
+    } else {
+        *watcher_list(hub, w) = w->next;
+    }
+    if (w->next) w->next->prev = w->prev;
+}
+
+static void close_watcher(SpectatorHub *hub, Watcher *w) {
+    unlink_watcher(hub, w);
+    epoll_ctl(hub->epfd, EPOLL_CTL_DEL, w->fd, NULL);
+    close(w->fd);
+    hub->watchers--;
+    free(w->tail);
+    free(w);
+}
+
+static void flush_tail(Watcher *w) {
+    while (w->tail_len > 0) {
+        ssize_t n = send(w->fd, w->tail, w->tail_len, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        if (n <= 0) {
+            w->closing = true;
+            return;
+        }
+        memmove(w->tail, w->tail + n, w->tail_len - (size_t)n);
+        w->tail_len -= (size_t)n;
+    }
+}
+
+// A watcher whose socket is full simply misses this version
+static void send_frame(Watcher *w, const char *frame, size_t len, uint32_t version) {
+    ssize_t n;
+    do {
+        n = send(w->fd, frame, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) w->closing = true;
+        return;
+    }
+    w->sent = true;
+    w->version = version;
+    if ((size_t)n == len) return;
+
+    if (!w->tail) w->tail = malloc(TABLE_FRAME_MAX);
+    if (!w->tail) {
+        w->closing = true;
+        return;
+    }
+    memcpy(w->tail, frame + n, len - (size_t)n);
+    w->tail_len = len - (size_t)n;
+}
+
+static void accept_watchers(SpectatorHub *hub) {
+    while (1) {
+        int fd = accept4(hub->listen_sock, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) perror("[SPECTATOR] accept failed");
+            return;
+        }
+        Watcher *w = calloc(1, sizeof(Watcher));
+        if (!w) {
+            close(fd);
+            continue;
+        }
+        w->fd = fd;
+        w->table = -1;
+        w->hello_due = tw_now_ms() + SPECTATE_HELLO_MS;
+
+        struct epoll_event ev = { .events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, .data.ptr = w };
+        if (epoll_ctl(hub->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            perror("[SPECTATOR] epoll_ctl failed");
+            close(fd);
+            free(w);
+            continue;
+        }
+        link_watcher(hub, w);
+        hub->watchers++;
+    }
+}
+
+static void read_watcher(SpectatorHub *hub, Watcher *w) {
+    while (!w->closing) {
+        char *at = w->table < 0 ? w->in + w->in_len : w->in;
+        size_t room = w->table < 0 ? sizeof(w->in) - 1 - w->in_len : sizeof(w->in);
+        ssize_t n = recv(w->fd, at, room, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        if (n <= 0) {
+            w->closing = true;
+            return;
+        }
+        if (w->table >= 0) continue;   // Watchers have nothing more to say
+
+        w->in_len += (size_t)n;
+        w->in[w->in_len] = '\0';
+        if (memchr(w->in, '\n', w->in_len) == NULL && w->in_len < sizeof(w->in) - 1) continue;
+
+        int table = spectator_parse(w->in, hub->dir->table_count);
+        if (table < 0) {
+            send_usage(w->fd, hub->dir->table_count);
+            w->closing = true;
+            return;
+        }
+        unlink_watcher(hub, w);
+        w->table = table;
+        link_watcher(hub, w);
+
+        // First frame right away; the ticks keep it current
+        uint32_t version;
+        size_t len = spectator_frame(get_table(hub->dir, table), hub->frame, &version);
+        send_frame(w, hub->frame, len, version);
+    }
+}
+
+SpectatorHub* spectator_hub_create(int listen_sock, TableDirectory *dir) {
+    SpectatorHub *hub = calloc(1, sizeof(SpectatorHub));
+    if (!hub) return NULL;
+    hub->epfd = -1;
+    hub->listen_sock = listen_sock;
+    hub->dir = dir;
+    hub->by_table = calloc((size_t)dir->table_count, sizeof(Watcher *));
+    if (hub->by_table) hub->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (!hub->by_table || hub->epfd < 0) {
+        spectator_hub_destroy(hub);
+        return NULL;
+    }
+
+    // Without a spectator port the hub stays empty
+    if (listen_sock < 0) return hub;
+
+    // data.ptr == NULL marks the listening socket, drained until EAGAIN
+    int flags = fcntl(listen_sock, F_GETFL, 0);
+    struct epoll_event lev = { .events = EPOLLIN, .data.ptr = NULL };
+    if (flags < 0 || fcntl(listen_sock, F_SETFL, flags | O_NONBLOCK) < 0 ||
+        epoll_ctl(hub->epfd, EPOLL_CTL_ADD, listen_sock, &lev) < 0) {
+        spectator_hub_destroy(hub);
+        return NULL;
+    }
+    return hub;
+}
+
+int spectator_hub_fd(SpectatorHub *hub) {
+    return hub->epfd;
+}
+
+void spectator_hub_dispatch(SpectatorHub *hub) {
+    struct epoll_event events[HUB_EVENTS];
+    int n = epoll_wait(hub->epfd, events, HUB_EVENTS, 0);
+    for (int i = 0; i < n; i++) {
+        Watcher *w = events[i].data.ptr;
+        if (w == NULL) {
+            accept_watchers(hub);
+            continue;
+        }
+        if (events[i].events & EPOLLOUT) flush_tail(w);
+        if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) read_watcher(hub, w);
+        if (w->closing) close_watcher(hub, w);
+    }
+}
+
+/**
+ * Once per tick: every table with watchers here whose version moved is
+ * copied out of shared memory once, and that one buffer goes to each of
+ * its watchers that is not still draining an older frame.
+ */
+int spectator_hub_tick(SpectatorHub *hub) {
+    if (hub->watchers == 0) return -1;
+    uint64_t now = tw_now_ms();
+    if (now < hub->next_tick) return (int)(hub->next_tick - now);
+    hub->next_tick = now + SPECTATE_TICK_MS;
+
+    for (Watcher *w = hub->pending, *next; w; w = next) {
+        next = w->next;
+        if (now >= w->hello_due) close_watcher(hub, w);
+    }
+
+    for (int t = 0; t < hub->dir->table_count; t++) {
+        if (!hub->by_table[t]) continue;
+        GameState *gs = get_table(hub->dir, t);
+        uint32_t current = atomic_load(&gs->state_version);
+        size_t len = 0;
+        uint32_t version = 0;
+
+        for (Watcher *w = hub->by_table[t], *next; w; w = next) {
+            next = w->next;
+            if (w->tail_len > 0 || (w->sent && w->version == current)) continue;
+            if (len == 0) len = spectator_frame(gs, hub->frame, &version);
+            if (!w->sent || w->version != version) send_frame(w, hub->frame, len, version);
+            if (w->closing) close_watcher(hub, w);
+        }
+    }
+    return SPECTATE_TICK_MS;
+}
+
+void spectator_hub_destroy(SpectatorHub *hub) {
+    if (!hub) return;
+    if (hub->by_table) {
+        for (int t = 0; t < hub->dir->table_count; t++) {
+            while (hub->by_table[t]) close_watcher(hub, hub->by_table[t]);
+        }
+    }
+    while (hub->pending) close_watcher(hub, hub->pending);
+    if (hub->epfd >= 0) close(hub->epfd);
+    free(hub->by_table);
+    free(hub);
+}
@@ -0,0 +1,123 @@
+// src/stats.c
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "stats.h"
+
+// Inherited by every forked worker and client process; NULL = stats off
+static StatsRegion *stats_region = NULL;
+static pid_t stats_owner = 0;
+
+int init_stats(void) {
+    int fd = shm_open(STATS_SHM_NAME, O_CREAT | O_RDWR, 0644);
+    if (fd == -1) {
+        perror("[ERROR] Stats shm_open failed");
+        return -1;
+    }
+    if (ftruncate(fd, sizeof(StatsRegion)) == -1) {
+        perror("[ERROR] Stats ftruncate failed");
+        close(fd);
+        return -1;
+    }
+    StatsRegion *region = mmap(NULL, sizeof(StatsRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (region == MAP_FAILED) {
+        perror("[ERROR] Stats mmap failed");
+        return -1;
+    }
+
+    // A region left behind by a crashed run holds stale numbers
+    memset(region, 0, sizeof(StatsRegion));
+    region->version = STATS_VERSION;
+    region->server_pid = getpid();
+    region->started = (int64_t)time(NULL);
+    atomic_thread_fence(memory_order_release);
+    region->magic = STATS_MAGIC;
+
+    stats_region = region;
+    stats_owner = getpid();
+    return 0;
+}
+
+void shutdown_stats(void) {
+    if (stats_region == NULL || stats_owner != getpid()) return;
+    munmap(stats_region, sizeof(StatsRegion));
+    stats_region = NULL;
+    shm_unlink(STATS_SHM_NAME);
+}
+
+uint64_t stats_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int stats_bucket(uint64_t ns) {
+    if (ns < STATS_SUB_BUCKETS) return (int)ns;
+    int exp = 63 - __builtin_clzll(ns);     // >= STATS_SUB_BITS
+    int sub = (int)(ns >> (exp - STATS_SUB_BITS)) & (STATS_SUB_BUCKETS - 1);
+    return ((exp - STATS_SUB_BITS + 1) << STATS_SUB_BITS) + sub;
+}
+
+uint64_t stats_bucket_high(int bucket) {
+    if (bucket < STATS_SUB_BUCKETS) return (uint64_t)bucket;
+    int exp = (bucket >> STATS_SUB_BITS) + STATS_SUB_BITS - 1;
+    uint64_t sub = (uint64_t)(bucket & (STATS_SUB_BUCKETS - 1));
+    uint64_t low = (STATS_SUB_BUCKETS + sub) << (exp - STATS_SUB_BITS);
+    return low + (1ULL << (exp - STATS_SUB_BITS)) - 1;
+}
+
+void stats_record(StatId id, uint64_t ns) {
+    StatsRegion *region = stats_region;
+    if (region == NULL) return;
+
+    StatsHistogram *h = &region->hist[id];
+    atomic_fetch_add_explicit(&h->buckets[stats_bucket(ns)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum, ns, memory_order_relaxed);
+    uint64_t max = atomic_load_explicit(&h->max, memory_order_relaxed);
+    while (ns > max && !atomic_compare_exchange_weak_explicit(&h->max, &max, ns,
+                                                              memory_order_relaxed,
+                                                              memory_order_relaxed)) {}
+    // Last, so a reader never sees a count its buckets do not add up to
+    atomic_fetch_add_explicit(&h->count, 1, memory_order_release);
+}
+
+void stats_since(StatId id, uint64_t start_ns) {
+    if (start_ns == 0 || stats_region == NULL) return;
+    uint64_t now = stats_now();
+    stats_record(id, now > start_ns ? now - start_ns : 0);
+}
+
+void stats_count(CounterId id) {
+    StatsRegion *region = stats_region;
+    if (region) atomic_fetch_add_explicit(&region->counters[id], 1, memory_order_relaxed);
+}
+
+uint64_t stats_counter(CounterId id) {
+    StatsRegion *region = stats_region;
+    return region ? atomic_load_explicit(&region->counters[id], memory_order_relaxed) : 0;
+}
+
+uint64_t stats_samples(StatId id) {
+    StatsRegion *region = stats_region;
+    return region ? atomic_load_explicit(&region->hist[id].count, memory_order_acquire) : 0;
+}
+
+const char* stats_name(StatId id) {
+    static const char *names[STAT_COUNT] = {
+        "accept->first STATE",
+        "action->STATE",
+        "turn handoff",
+        "shoe swap at cut",
+        "round duration",
+    };
+    return id < STAT_COUNT ? names[id] : "?";
+}
+
+const char* stats_counter_name(CounterId id) {
+    static const char *names[CTR_COUNT] = { "accepted", "refused", "disconnected", "actions" };
+    return id < CTR_COUNT ? names[id] : "?";
+}
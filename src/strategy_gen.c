@@ -0,0 +1,108 @@
+// src/strategy_gen.c
+// Build-time generator for the basic-strategy table (strategy.h). Solves an
+// approximation of this server's game, assuming an infinite shoe, and
+// prints the table as C source; the Makefile compiles that output into the
+// server and bjsim, so deciding a hand at runtime is one array load.
+//
+// The game has no dealer: the highest total that did not bust wins, the
+// lower seat on a tie. The model lets each seat play its whole hand before
+// the next one starts, so a seat has to end strictly above 'to_beat', the
+// best total among seats that already finished, and then hope every seat
+// after it fails to beat its own total. Live turns pass to the next seat
+// after every hit, so a seat sometimes decides before earlier seats have
+// finished; the table is optimal for the model, not for that interleaving.
+// Every seat is assumed to play this same strategy. (The rare round where
+// everybody busts goes to the first seat; the model counts it as a loss.)
+#include <stdio.h>
+#include "rules.h"
+#include "strategy.h"
+
+#define HARD_MAX 21
+#define P_RANK (1.0 / 13.0)
+
+// 1 = hit, filled in seats_after order by solve_seat()
+static unsigned char hit[STRATEGY_SEATS][STRATEGY_TARGETS][2][HARD_MAX + 1];
+
+// fail[j][b]: chance a fresh seat with j seats after it ends at or below b
+static double fail[STRATEGY_SEATS][HARD_MAX + 1];
+
+// Chance a seat standing on 'total' with r seats after it wins
+static double stand_value(int total, int to_beat, int r) {
+    if (total <= to_beat) return 0.0;
+    double p = 1.0;
+    for (int j = 0; j < r; j++) p *= fail[j][total];
+    return p;
+}
+
+/**
+ * Best play for every hand facing 'to_beat' with r seats after. Hard
+ * totals only grow, so each state is solved from the larger ones above it.
+ * Also returns, through beat[][], the chance of finishing above to_beat
+ * when playing that way (what the seats before this one fear).
+ */
+static void solve_target(int r, int to_beat, double beat[2][HARD_MAX + 1]) {
+    double win[2][HARD_MAX + 1];
+    for (int hard = HARD_MAX; hard >= 2; hard--) {
+        for (int ace = 0; ace < 2; ace++) {
+            int total = hand_total(hard, ace);
+            double stand = stand_value(total, to_beat, r);
+            double hit_win = 0.0, hit_beat = 0.0;
+            for (int rank = 1; rank <= 13; rank++) {
+                int next = hard + card_value[rank];
+                if (next > HARD_MAX) continue;                  // Bust: no chance
+                int next_ace = ace | (rank == 1);
+                hit_win += P_RANK * win[next_ace][next];
+                hit_beat += P_RANK * beat[next_ace][next];
+            }
+            // Ties stand: never draw without a reason
+            bool hits = hit_win > stand;
+            hit[r][to_beat + 1][ace][hard] = hits;
+            win[ace][hard] = hits ? hit_win : stand;
+            beat[ace][hard] = hits ? hit_beat : (total > to_beat);
+        }
+    }
+}
+
+static void solve_seat(int r) {
+    for (int to_beat = -1; to_beat <= HARD_MAX; to_beat++) {
+        double beat[2][HARD_MAX + 1];
+        solve_target(r, to_beat, beat);
+        if (to_beat < 0) continue;
+
+        // Average over the first two cards
+        double p_beat = 0.0;
+        for (int a = 1; a <= 13; a++) {
+            for (int b = 1; b <= 13; b++) {
+                int hard = card_value[a] + card_value[b];
+                p_beat += P_RANK * P_RANK * beat[a == 1 || b == 1][hard];
+            }
+        }
+        fail[r][to_beat] = 1.0 - p_beat;
+    }
+}
+
+int main(void) {
+    // A seat only looks at seats after it, so solve the last seat first
+    for (int r = 0; r < STRATEGY_SEATS; r++) solve_seat(r);
+
+    printf("// Generated by strategy_gen (src/strategy_gen.c). Do not edit.\n");
+    printf("#include \"strategy.h\"\n\n");
+    printf("const uint8_t strategy_table[STRATEGY_SEATS][STRATEGY_TARGETS][2][STRATEGY_HARD] = {\n");
+    for (int r = 0; r < STRATEGY_SEATS; r++) {
+        printf("  { // %d seat(s) after\n", r);
+        for (int t = 0; t < STRATEGY_TARGETS; t++) {
+            printf("    { ");
+            for (int ace = 0; ace < 2; ace++) {
+                printf("{");
+                for (int hard = 0; hard < STRATEGY_HARD; hard++) {
+                    printf("%s%d", hard ? "," : "", hard <= HARD_MAX ? hit[r][t][ace][hard] : 0);
+                }
+                printf("}%s", ace ? "" : ", ");
+            }
+            printf(" }, // to beat %d\n", t - 1);
+        }
+        printf("  },\n");
+    }
+    printf("};\n");
+    return 0;
+}
@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "timer_wheel.h"
+
+#define TW_MASK (TW_SLOTS - 1)
+#define TW_MAX_DELTA ((1ULL << (TW_LEVELS * TW_BITS)) - 1)
+#define TW_NEVER UINT64_MAX
+
+uint64_t tw_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+void tw_init(TimerWheel *tw, uint64_t now_ms) {
+    memset(tw, 0, sizeof(*tw));
+    tw->now = now_ms;
+}
+
+// --- 1. SLOT LISTS ---
+
+static void slot_insert(TimerWheel *tw, TimerNode *node, int level, int slot) {
+    TimerNode **head = &tw->slots[level][slot];
+    node->level = level;
+    node->slot = slot;
+    node->prev = NULL;
+    node->next = *head;
+    if (*head) (*head)->prev = node;
+    *head = node;
+    tw->occupied[level] |= 1ULL << slot;
+}
+
+static void slot_remove(TimerWheel *tw, TimerNode *node) {
+    TimerNode **head = &tw->slots[node->level][node->slot];
+    if (node->prev) node->prev->next = node->next;
+    else *head = node->next;
+    if (node->next) node->next->prev = node->prev;
+    if (*head == NULL) tw->occupied[node->level] &= ~(1ULL << node->slot);
+    node->next = node->prev = NULL;
+}
+
+// Pick the level whose slot width matches how far away the deadline is
+static void place(TimerWheel *tw, TimerNode *node) {
+    uint64_t expires = node->expires < tw->now ? tw->now : node->expires;
+    uint64_t delta = expires - tw->now;
+    if (delta > TW_MAX_DELTA) {
+        // Parked at the far edge; re-placed when that slot cascades
+        delta = TW_MAX_DELTA;
+        expires = tw->now + delta;
+    }
+
+    int level = 0;
+    while (level < TW_LEVELS - 1 && delta >= (1ULL << ((level + 1) * TW_BITS))) {
+        level++;
+    }
+    slot_insert(tw, node, level, (int)((expires >> (level * TW_BITS)) & TW_MASK));
+}
+
+// --- 2. ARM / CANCEL ---
+
+void tw_arm(TimerWheel *tw, TimerNode *node, uint64_t expires_ms) {
+    if (node->armed) {
+        slot_remove(tw, node);
+    } else {
+        tw->count++;
+    }
+    node->armed = true;
+    node->expires = expires_ms;
+    place(tw, node);
+}
+
+void tw_cancel(TimerWheel *tw, TimerNode *node) {
+    if (!node->armed) return;
+    slot_remove(tw, node);
+    node->armed = false;
+    tw->count--;
+}
+
+// --- 3. ADVANCING TIME ---
+
+// Distance from 'from' to the next set bit, wrapping around; -1 if none
+static int next_bit(uint64_t map, int from) {
+    if (map == 0) return -1;
+    uint64_t rot = from ? (map >> from) | (map << (TW_SLOTS - from)) : map;
+    return __builtin_ctzll(rot);
+}
+
+/**
+ * Earliest tick at which some slot must be processed: the next occupied
+ * level-0 slot, or the block boundary where an occupied higher-level slot
+ * cascades down. Constant cost: one bitmap scan per level.
+ */
+static uint64_t next_event(TimerWheel *tw) {
+    uint64_t best = TW_NEVER;
+
+    int d = next_bit(tw->occupied[0], (int)(tw->now & TW_MASK));
+    if (d >= 0) best = tw->now + (uint64_t)d;
+
+    for (int level = 1; level < TW_LEVELS; level++) {
+        if (tw->occupied[level] == 0) continue;
+        int shift = level * TW_BITS;
+        uint64_t block = tw->now >> shift;
+        uint64_t first = (tw->now & ((1ULL << shift) - 1)) == 0 ? block : block + 1;
+        d = next_bit(tw->occupied[level], (int)(first & TW_MASK));
+        uint64_t when = (first + (uint64_t)d) << shift;
+        if (when < best) best = when;
+    }
+    return best;
+}
+
+// Move one higher-level slot down now that its block has started
+static void cascade(TimerWheel *tw, int level, int slot) {
+    TimerNode *node = tw->slots[level][slot];
+    tw->slots[level][slot] = NULL;
+    tw->occupied[level] &= ~(1ULL << slot);
+    while (node) {
+        TimerNode *next = node->next;
+        place(tw, node);
+        node = next;
+    }
+}
+
+static void process_tick(TimerWheel *tw, TimerCallback cb, void *ctx) {
+    uint64_t now = tw->now;
+
+    for (int level = TW_LEVELS - 1; level >= 1; level--) {
+        int shift = level * TW_BITS;
+        if ((now & ((1ULL << shift) - 1)) == 0) {
+            cascade(tw, level, (int)((now >> shift) & TW_MASK));
+        }
+    }
+
+    int slot = (int)(now & TW_MASK);
+    TimerNode *node = tw->slots[0][slot];
+    tw->slots[0][slot] = NULL;
+    tw->occupied[0] &= ~(1ULL << slot);
+    while (node) {
+        TimerNode *next = node->next;
+        node->next = node->prev = NULL;
+        if (node->expires > now) {
+            place(tw, node); // Parked beyond the wheel's range
+        } else {
+            node->armed = false;
+            tw->count--;
+            cb(node, ctx);   // May re-arm node
+        }
+        node = next;
+    }
+}
+
+void tw_advance(TimerWheel *tw, uint64_t now_ms, TimerCallback cb, void *ctx) {
+    while (tw->now <= now_ms) {
+        uint64_t ev = next_event(tw);
+        if (ev > now_ms) {
+            tw->now = now_ms + 1;
+            break;
+        }
+        tw->now = ev;
+        process_tick(tw, cb, ctx);
+        tw->now = ev + 1;
+    }
+}
+
+int tw_timeout_ms(TimerWheel *tw, uint64_t now_ms) {
+    if (tw->count == 0) return -1;
+    uint64_t ev = next_event(tw);
+    if (ev == TW_NEVER) return -1;
+    if (ev <= now_ms) return 0;
+    uint64_t wait = ev - now_ms;
+    return wait > 0x7fffffff ? 0x7fffffff : (int)wait;
+}
@@ -0,0 +1,43 @@
+#include <errno.h>
+#include <time.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "wait_queue.h"
+
+// Shared (non-private) futex ops: the word may be mapped by many processes
+static long futex(_Atomic uint32_t *addr, int op, uint32_t val, const struct timespec *ts) {
+    return syscall(SYS_futex, (uint32_t *)addr, op, val, ts, NULL, 0);
+}
+
+uint32_t wq_prepare(WaitQueue *wq) {
+    return atomic_load_explicit(&wq->seq, memory_order_acquire);
+}
+
+int wq_wait(WaitQueue *wq, uint32_t seen, int timeout_ms) {
+    struct timespec ts, *tsp = NULL;
+    if (timeout_ms >= 0) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+        tsp = &ts;
+    }
+
+    atomic_fetch_add_explicit(&wq->waiters, 1, memory_order_seq_cst);
+    long rc = 0;
+    // The kernel re-checks seq == seen atomically, so a wake between
+    // wq_prepare() and here is never lost (we get EAGAIN instead)
+    if (atomic_load_explicit(&wq->seq, memory_order_seq_cst) == seen) {
+        rc = futex(&wq->seq, FUTEX_WAIT, seen, tsp);
+    }
+    atomic_fetch_sub_explicit(&wq->waiters, 1, memory_order_relaxed);
+
+    return (rc == -1 && errno == ETIMEDOUT) ? -1 : 0;
+}
+
+void wq_wake_all(WaitQueue *wq) {
+    atomic_fetch_add_explicit(&wq->seq, 1, memory_order_seq_cst);
+    if (atomic_load_explicit(&wq->waiters, memory_order_seq_cst) > 0) {
+        futex(&wq->seq, FUTEX_WAKE, INT_MAX, NULL);
+    }
+}
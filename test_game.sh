@@ -2,33 +2,41 @@
 
 # Configuration
 SERVER_EXE="./server"
-CLIENT_EXE="./client"
+LOAD_EXE="./bjload"
 NUM_PLAYERS=3
+FAILED=0
+
+# Starts the server with the given options and plays $NUM_PLAYERS bots
+# against it. Two workers, so players accepted by one worker get seated at
+# the other's table too; every bot has to finish its rounds.
+play_rounds() {
+    echo "[DevOps] Starting Server ($*)..."
+    $SERVER_EXE "$@" &
+    SERVER_PID=$!
+    sleep 2 # Give server time to bind to port
+
+    echo "[DevOps] Launching $NUM_PLAYERS bot players..."
+    $LOAD_EXE --bots $NUM_PLAYERS --threads 1 --rounds 2 --think 100-500 --duration 20 | tee bjload.out
+    if grep -q "Unfinished" bjload.out; then
+        echo "❌ FAIL: Some bots never got a full table ($*)."
+        FAILED=1
+    else
+        echo "✅ SUCCESS: All bots finished their rounds ($*)."
+    fi
+    rm -f bjload.out
+}
 
 echo "--- 🎲 Blackjack System Integration Test ---"
 
 # 1. Clean up previous runs
 make clean-ipc
-rm -f game.log scores.txt
-
-# 2. Start the Server in the background
-echo "[DevOps] Starting Server..."
-$SERVER_EXE &
-SERVER_PID=$!
-sleep 2 # Give server time to bind to port
-
-# 3. Start Multiple Clients (Simulating real players)
-for i in $(seq 1 $NUM_PLAYERS)
-do
-    echo "[DevOps] Launching Player $i..."
-    # We use 'timeout' so the test doesn't hang forever
-    # We pipe input "S" (for Stay) to the client if it asks for a move
-    (echo "S"; sleep 2) | $CLIENT_EXE 127.0.0.1 &
-done
-
-# 4. Wait for game to progress
-echo "[DevOps] Waiting for game logs to populate..."
-sleep 10
+rm -f game.log scores.db
+
+# 2-3. Start the Server and play a few rounds with bots (Simulating real players)
+play_rounds --workers 2
+
+# 4. Let the server flush its logs
+sleep 1
 
 # 5. Verification Logic
 echo "--- 📊 Validation Results ---"
@@ -39,18 +47,29 @@ if [ -f "game.log" ]; then
     echo "   Log entries found: $LOG_COUNT"
 else
     echo "❌ FAIL: No game.log found."
+    FAILED=1
 fi
 
-if [ -f "scores.txt" ]; then
-    echo "✅ SUCCESS: Persistence file (scores.txt) created."
+if [ -f "scores.db" ]; then
+    echo "✅ SUCCESS: Persistence file (scores.db) created."
+    ./bjstat --scores
 else
-    echo "❌ FAIL: scores.txt missing."
+    echo "❌ FAIL: scores.db missing."
+    FAILED=1
 fi
 
 # 6. Shutdown
 echo "[DevOps] Cleaning up processes..."
 kill $SERVER_PID
-pkill client
+sleep 1
+make clean-ipc
+
+# 7. The same with one event loop per worker, where the worker that
+# accepts a player passes the connection to the table's own worker
+play_rounds --workers 2 --reactor
+kill $SERVER_PID
+sleep 1
 make clean-ipc
 
-echo "--- 🏁 Test Complete ---"
\ No newline at end of file
+echo "--- 🏁 Test Complete ---"
+exit $FAILED
\ No newline at end of file
@@ -0,0 +1,120 @@
+// tests/test_draw_stress.c
+// Many processes draw from one shared shoe at once while another process
+// shuffles spares and one drawer also swaps shoes at the cut card, as
+// reset_game_round() does. Every draw is logged with the cursor slot it
+// claimed; afterwards each card is checked against the shoe it came from
+// (replayed from the seed) and each shoe position must be dealt exactly
+// once. Usage: test_draw_stress [processes] [draws each] [decks]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "shoe.h"
+
+#define SEED 2024
+#define STREAM 9
+
+typedef struct {
+    uint64_t slot;
+    uint8_t card;
+} Draw;
+
+typedef struct {
+    Shoe shoe;
+    _Atomic int go;
+    _Atomic int stop;
+    _Atomic int drawers_done;
+} Shared;
+
+static void drawer(Shared *sh, Draw *log, int draws, bool cuts) {
+    while (!atomic_load(&sh->go)) {}
+    for (int i = 0; i < draws; i++) {
+        log[i].card = (uint8_t)shoe_draw_slot(&sh->shoe, &log[i].slot);
+        if (cuts && i % 7 == 0 && shoe_past_cut(&sh->shoe)) shoe_swap(&sh->shoe);
+    }
+    atomic_fetch_add(&sh->drawers_done, 1);
+}
+
+static void filler(Shared *sh) {
+    while (!atomic_load(&sh->stop)) shoe_fill_spare(&sh->shoe);
+}
+
+int main(int argc, char *argv[]) {
+    int procs = argc > 1 ? atoi(argv[1]) : 8;
+    int draws = argc > 2 ? atoi(argv[2]) : 100000;
+    int decks = argc > 3 ? atoi(argv[3]) : 1;
+    if (procs < 1 || draws < 1 || decks < 1 || decks > MAX_DECKS) {
+        fprintf(stderr, "Usage: %s [processes] [draws each] [decks]\n", argv[0]);
+        return 1;
+    }
+
+    size_t total = (size_t)procs * (size_t)draws;
+    Shared *sh = mmap(NULL, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    Draw *log = mmap(NULL, total * sizeof(Draw), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (sh == MAP_FAILED || log == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    ShoeConfig cfg = { decks, DEFAULT_PENETRATION, SEED };
+    shoe_init(&sh->shoe, &cfg, STREAM);
+
+    pid_t fill_pid = fork();
+    if (fill_pid == 0) {
+        filler(sh);
+        _exit(0);
+    }
+    for (int p = 0; p < procs; p++) {
+        if (fork() == 0) {
+            drawer(sh, log + (size_t)p * draws, draws, p == 0);
+            _exit(0);
+        }
+    }
+    atomic_store(&sh->go, 1);
+    while (atomic_load(&sh->drawers_done) < procs) usleep(1000);
+    atomic_store(&sh->stop, 1);
+    while (wait(NULL) > 0) {}
+
+    // Replay the shoes: the k-th shuffle of the stream is generation k
+    uint32_t gens = 0;
+    for (size_t i = 0; i < total; i++) {
+        if (SHOE_GEN(log[i].slot) + 1 > gens) gens = SHOE_GEN(log[i].slot) + 1;
+    }
+    int size = sh->shoe.size;
+    uint8_t *expect = malloc((size_t)gens * size);
+    uint8_t *seen = calloc((size_t)gens * size, 1);
+    Rng rng;
+    rng_seed(&rng, SEED, STREAM);
+    for (uint32_t g = 0; g < gens; g++) {
+        uint8_t *cards = expect + (size_t)g * size;
+        int idx = 0;
+        for (int d = 0; d < decks; d++) {
+            for (int s = 0; s < 4; s++) {
+                for (int v = 1; v <= 13; v++) cards[idx++] = (uint8_t)v;
+            }
+        }
+        shuffle_cards(cards, size, &rng);
+    }
+
+    long wrong = 0, dup = 0, holes = 0, partial = 0;
+    for (size_t i = 0; i < total; i++) {
+        size_t at = (size_t)SHOE_GEN(log[i].slot) * size + SHOE_IDX(log[i].slot);
+        if (SHOE_IDX(log[i].slot) >= (uint32_t)size || log[i].card != expect[at]) wrong++;
+        else if (seen[at]++) dup++;
+    }
+    // Each shoe is dealt from the top with no gaps: all of it, or up to a cut
+    for (uint32_t g = 0; g < gens; g++) {
+        int dealt = 0;
+        while (dealt < size && seen[(size_t)g * size + dealt]) dealt++;
+        for (int i = dealt; i < size; i++) holes += seen[(size_t)g * size + i] != 0;
+        if (dealt < size && g + 1 < gens) partial++;
+    }
+
+    printf("test_draw_stress: %d processes x %d draws, %u shoes (%ld cut early), "
+           "%u inline fills: %ld wrong, %ld duplicate, %ld out of order\n",
+           procs, draws, gens, partial, atomic_load(&sh->shoe.inline_fills), wrong, dup, holes);
+    free(expect);
+    free(seen);
+    return (wrong || dup || holes) ? 1 : 0;
+}
@@ -0,0 +1,76 @@
+// tests/test_odds.c
+// Checks odds.h two ways: the one-card distribution against the bust figure
+// the turn prompt sends, and ShoeCounts synced incrementally across several
+// shoes against a fresh count at every step.
+#include <stdio.h>
+#include <math.h>
+#include "odds.h"
+#include "rules.h"
+
+#define EPS 1e-4
+
+static int failures;
+static long hands_checked, syncs_checked;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { if (failures++ < 10) { fprintf(stderr, "FAIL: " __VA_ARGS__); fprintf(stderr, "\n"); } } \
+} while (0)
+
+// Part-dealt single-deck shoes, every hand: one more card sums to 1, and
+// its bust chance is the figure the turn prompt sends
+static void test_hit(void) {
+    Shoe shoe;
+    ShoeConfig cfg = { 1, DEFAULT_PENETRATION, 7 };
+    shoe_init(&shoe, &cfg, 0);
+
+    for (int dealt = 0; dealt <= 40; dealt += 8) {
+        ShoeCounts c;
+        odds_count(&c, shoe.cards[0] + dealt, DECK_SIZE - dealt);
+        for (int hard = 2; hard <= 21; hard++) {
+            for (int aces = 0; aces <= 1; aces++) {
+                OddsDist d;
+                odds_hit(&c, hard, aces, &d);
+                hands_checked++;
+                double sum = d.bust;
+                for (int t = 0; t <= 21; t++) sum += d.total[t];
+                CHECK(fabs(sum - 1.0) < EPS, "hit hard=%d aces=%d: sums to %.6f", hard, aces, sum);
+                CHECK(fabs(d.bust * 1000 - odds_bust_permille(&c, hard)) <= 0.5 + EPS,
+                      "bust on %d: %.4f vs %d/1000", hard, d.bust, odds_bust_permille(&c, hard));
+            }
+        }
+    }
+}
+
+// Synced every few draws, across cut cards and exhausted shoes
+static void test_sync(void) {
+    Shoe shoe;
+    ShoeConfig cfg = { 2, DEFAULT_PENETRATION, 11 };
+    shoe_init(&shoe, &cfg, 0);
+    ShoeCounts live = { .synced = false };
+    Rng rng;
+    rng_seed(&rng, 3, 0);
+
+    for (int step = 0; step < 5000; step++) {
+        int draws = (int)rng_below(&rng, 6);
+        for (int i = 0; i < draws; i++) shoe_draw_owned(&shoe);
+        if (step % 97 == 0) shoe_swap(&shoe);
+
+        ShoeCounts fresh = { .synced = false };
+        odds_sync(&live, &shoe);
+        odds_sync(&fresh, &shoe);
+        syncs_checked++;
+        CHECK(live.total == fresh.total, "step %d: %d cards left, recount says %d",
+              step, live.total, fresh.total);
+        for (int v = 0; v < ODDS_VALUES; v++) {
+            CHECK(live.count[v] == fresh.count[v], "step %d: value %d: %d left, recount says %d",
+                  step, v + 1, live.count[v], fresh.count[v]);
+        }
+    }
+}
+
+int main(void) {
+    test_hit();
+    test_sync();
+    printf("test_odds: %ld hands, %ld syncs, %d failures\n", hands_checked, syncs_checked, failures);
+    return failures ? 1 : 0;
+}
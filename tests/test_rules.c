@@ -0,0 +1,59 @@
+// tests/test_rules.c
+// Checks the running totals kept by add_card() against calculate_points()
+// on every hand that can come up in play: every sequence of ranks, dealt
+// one card at a time, until the hand busts or holds MAX_CARDS.
+#include <stdio.h>
+#include <string.h>
+#include "rules.h"
+
+static long hands_checked;
+static int failures;
+
+static void fail(const PlayerState *p, const char *what) {
+    if (failures++ >= 10) return;
+    fprintf(stderr, "FAIL %s: cards=", what);
+    for (int i = 0; i < p->card_count; i++) fprintf(stderr, "%d ", p->cards[i]);
+    fprintf(stderr, "points=%d hard=%d aces=%d\n", p->points, p->hard_total, p->aces);
+}
+
+static void check(const PlayerState *p) {
+    int expect = calculate_points(p->cards, p->card_count);
+    int hard = 0;
+    for (int i = 0; i < p->card_count; i++) hard += p->cards[i] >= 10 ? 10 : p->cards[i];
+
+    hands_checked++;
+    if (p->points != expect) fail(p, "points");
+    if (hand_busted(p) != (expect > 21)) fail(p, "busted");
+    if (hand_is_soft(p) != (expect != hard)) fail(p, "soft");
+    if (hand_is_blackjack(p) != (p->card_count == 2 && expect == 21)) fail(p, "blackjack");
+}
+
+static void deal_all(const PlayerState *p) {
+    for (int card = 1; card <= 13; card++) {
+        PlayerState next = *p;
+        if (!add_card(&next, card)) {
+            fail(p, "add_card refused a card below MAX_CARDS");
+            continue;
+        }
+        check(&next);
+        if (!hand_busted(&next) && next.card_count < MAX_CARDS) deal_all(&next);
+    }
+}
+
+int main(void) {
+    PlayerState p;
+    memset(&p, 0, sizeof(p));
+    reset_player_state(&p);
+    check(&p);
+    deal_all(&p);
+
+    // A full hand takes no more cards and is left as it was
+    PlayerState full;
+    memset(&full, 0, sizeof(full));
+    for (int i = 0; i < MAX_CARDS; i++) add_card(&full, 1);
+    PlayerState before = full;
+    if (add_card(&full, 2) || memcmp(&before, &full, sizeof(full)) != 0) fail(&full, "full hand");
+
+    printf("test_rules: %ld hands, %d failures\n", hands_checked, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,155 @@
+// tests/test_shoe.c
+// Shoe contents, cut card, seeding, and chi-square uniformity checks of
+// the Fisher-Yates shuffle. Seeds are fixed, so results are repeatable.
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include "shoe.h"
+#include "rules.h"
+
+static int failures;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { failures++; fprintf(stderr, "FAIL: " __VA_ARGS__); fprintf(stderr, "\n"); } \
+} while (0)
+
+// Chi-square against a uniform expectation; passes below df + 6 sigma
+static bool uniform(const long *counts, int bins, long trials, double *stat) {
+    double expect = (double)trials / bins, chi = 0;
+    for (int i = 0; i < bins; i++) {
+        double d = (double)counts[i] - expect;
+        chi += d * d / expect;
+    }
+    *stat = chi;
+    int df = bins - 1;
+    return chi < df + 6.0 * sqrt(2.0 * df);
+}
+
+static void test_contents_and_cut(void) {
+    for (int decks = 1; decks <= MAX_DECKS; decks++) {
+        ShoeConfig cfg = { decks, DEFAULT_PENETRATION, 1 };
+        Shoe shoe;
+        shoe_init(&shoe, &cfg, 0);
+
+        int ranks[14] = {0};
+        for (int i = 0; i < shoe.size; i++) ranks[shoe.cards[0][i]]++;
+        for (int v = 1; v <= 13; v++) {
+            CHECK(ranks[v] == 4 * decks, "%d decks: rank %d appears %d times", decks, v, ranks[v]);
+        }
+        CHECK(shoe.size == decks * DECK_SIZE, "%d decks: size %d", decks, shoe.size);
+        CHECK(shoe.cut <= shoe.size - RESHUFFLE_THRESHOLD, "%d decks: cut %d too deep", decks, shoe.cut);
+
+        while (!shoe_past_cut(&shoe)) shoe_draw(&shoe);
+        CHECK((int)shoe_dealt(&shoe) == shoe.cut + 1, "%d decks: cut came out at %u", decks,
+              shoe_dealt(&shoe));
+
+        // Drawing past the end reshuffles instead of running off the shoe
+        for (int i = 0; i < 2 * shoe.size; i++) {
+            int card = shoe_draw(&shoe);
+            CHECK(card >= 1 && card <= 13, "%d decks: drew %d", decks, card);
+        }
+    }
+
+    ShoeConfig six = { 6, 75, 1 };
+    Shoe shoe;
+    shoe_init(&shoe, &six, 0);
+    CHECK(shoe.cut == 6 * DECK_SIZE * 75 / 100, "6 decks at 75%%: cut %d", shoe.cut);
+}
+
+static void test_seeding(void) {
+    ShoeConfig cfg = { 2, DEFAULT_PENETRATION, 12345 };
+    Shoe a, b, c;
+    shoe_init(&a, &cfg, 7);
+    shoe_init(&b, &cfg, 7);
+    shoe_init(&c, &cfg, 8);
+    CHECK(memcmp(a.cards, b.cards, (size_t)a.size) == 0, "same seed and stream differ");
+    CHECK(memcmp(a.cards, c.cards, (size_t)a.size) != 0, "different streams match");
+}
+
+static _Atomic int filler_stop;
+
+static void* filler(void *arg) {
+    while (!atomic_load(&filler_stop)) shoe_fill_spare(arg);
+    return NULL;
+}
+
+// A background filler changes who shuffles, never what gets dealt
+static void test_background_fill(void) {
+    enum { SHOES = 2000 };
+    ShoeConfig cfg = { 1, DEFAULT_PENETRATION, 77 };
+    static Shoe inline_shoe, bg_shoe;
+    shoe_init(&inline_shoe, &cfg, 3);
+    shoe_init(&bg_shoe, &cfg, 3);
+
+    pthread_t tid;
+    atomic_store(&filler_stop, 0);
+    pthread_create(&tid, NULL, filler, &bg_shoe);
+    int mismatches = 0;
+    for (int i = 0; i < SHOES * DECK_SIZE; i++) {
+        mismatches += shoe_draw(&inline_shoe) != shoe_draw(&bg_shoe);
+    }
+    atomic_store(&filler_stop, 1);
+    pthread_join(tid, NULL);
+    CHECK(mismatches == 0, "background fill changed %d of %d cards", mismatches, SHOES * DECK_SIZE);
+}
+
+// Every ordering of 5 cards equally likely (120 bins)
+static void test_permutations(void) {
+    enum { N = 5, PERMS = 120 };
+    const long trials = 1200000;
+    static long counts[PERMS];
+    Rng rng;
+    rng_seed(&rng, 99, 0);
+
+    for (long t = 0; t < trials; t++) {
+        uint8_t cards[N] = {0, 1, 2, 3, 4};
+        shuffle_cards(cards, N, &rng);
+        // Lehmer code -> permutation index
+        int index = 0;
+        for (int i = 0; i < N; i++) {
+            int smaller = 0;
+            for (int j = i + 1; j < N; j++) smaller += cards[j] < cards[i];
+            index = index * (N - i) + smaller;
+        }
+        counts[index]++;
+    }
+    double chi;
+    CHECK(uniform(counts, PERMS, trials, &chi), "5-card permutations not uniform (chi2 %.1f)", chi);
+    printf("  permutations of 5: chi2 = %.1f (df %d)\n", chi, PERMS - 1);
+}
+
+// Every card equally likely at every position of a 52-card deck
+static void test_positions(void) {
+    enum { N = DECK_SIZE };
+    const long trials = 200000;
+    static long counts[N * N];
+    Rng rng;
+    rng_seed(&rng, 7, 0);
+
+    for (long t = 0; t < trials; t++) {
+        uint8_t cards[N];
+        for (int i = 0; i < N; i++) cards[i] = (uint8_t)i;
+        shuffle_cards(cards, N, &rng);
+        for (int pos = 0; pos < N; pos++) counts[pos * N + cards[pos]]++;
+    }
+    // Each position's row is a multinomial over the 52 cards: N(N-1) df
+    double expect = (double)trials / N, chi = 0;
+    for (int i = 0; i < N * N; i++) {
+        double d = (double)counts[i] - expect;
+        chi += d * d / expect;
+    }
+    int df = N * (N - 1);
+    CHECK(chi < df + 6.0 * sqrt(2.0 * df), "card positions not uniform (chi2 %.1f)", chi);
+    printf("  card x position (52x52): chi2 = %.1f (df %d)\n", chi, df);
+}
+
+int main(void) {
+    test_contents_and_cut();
+    test_seeding();
+    test_background_fill();
+    test_permutations();
+    test_positions();
+    printf("test_shoe: %d failures\n", failures);
+    return failures ? 1 : 0;
+}
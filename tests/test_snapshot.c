@@ -0,0 +1,134 @@
+// tests/test_snapshot.c
+// Several processes rewrite one table inside table_write_begin/end while
+// others copy it with table_snapshot(). Every write sets the whole table
+// from a single number k (scores, cards, turn, round), so a copy that mixes
+// two writes is caught by comparing the fields. A reader that copies the
+// same fields without the seqlock runs alongside to show the writes really
+// do overlap the copies. Usage: test_snapshot [writers] [readers] [writes each]
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "shared_mem.h"
+
+typedef struct {
+    GameState table;
+    _Atomic int go;
+    _Atomic int writers_done;
+    _Atomic long snapshots;
+    _Atomic long torn;
+    _Atomic long unlocked_torn;
+} Shared;
+
+static void write_table(GameState *gs, int k) {
+    table_write_begin(gs);
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        PlayerState *p = &gs->players[i];
+        p->card_count = 1 + k % MAX_CARDS;
+        for (int c = 0; c < MAX_CARDS; c++) p->cards[c] = k;
+        p->points = k;
+        p->hard_total = k;
+        p->standing = k & 1;
+    }
+    gs->current_turn = k % MAX_PLAYERS;
+    gs->winner = k;
+    gs->round_number = k;
+    table_write_end(gs);
+}
+
+// Does the copy come from one write?
+static bool consistent(const TableSnapshot *s) {
+    int k = s->round_number;
+    if (s->current_turn != k % MAX_PLAYERS || s->winner != k) return false;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        const PlayerState *p = &s->players[i];
+        if (p->card_count != 1 + k % MAX_CARDS || p->points != k ||
+            p->hard_total != k || p->standing != (bool)(k & 1)) {
+            return false;
+        }
+        for (int c = 0; c < MAX_CARDS; c++) {
+            if (p->cards[c] != k) return false;
+        }
+    }
+    return true;
+}
+
+static void writer(Shared *sh, int w, int writers, int writes) {
+    while (!atomic_load(&sh->go)) {}
+    for (int i = 0; i < writes; i++) write_table(&sh->table, w + i * writers);
+    atomic_fetch_add(&sh->writers_done, 1);
+}
+
+static void reader(Shared *sh, int writers) {
+    TableSnapshot snap;
+    long taken = 0, torn = 0;
+    while (!atomic_load(&sh->go)) {}
+    while (atomic_load(&sh->writers_done) < writers) {
+        table_snapshot(&sh->table, &snap);
+        taken++;
+        torn += !consistent(&snap);
+    }
+    atomic_fetch_add(&sh->snapshots, taken);
+    atomic_fetch_add(&sh->torn, torn);
+}
+
+// The same copy with no retry loop: expected to tear
+static void unlocked_reader(Shared *sh, int writers) {
+    volatile GameState *gs = &sh->table;
+    TableSnapshot snap;
+    long torn = 0;
+    while (!atomic_load(&sh->go)) {}
+    while (atomic_load(&sh->writers_done) < writers) {
+        for (int i = 0; i < MAX_PLAYERS; i++) snap.players[i] = gs->players[i];
+        snap.current_turn = gs->current_turn;
+        snap.winner = gs->winner;
+        snap.round_number = gs->round_number;
+        torn += !consistent(&snap);
+    }
+    atomic_store(&sh->unlocked_torn, torn);
+}
+
+int main(int argc, char *argv[]) {
+    int writers = argc > 1 ? atoi(argv[1]) : 2;
+    int readers = argc > 2 ? atoi(argv[2]) : 4;
+    int writes = argc > 3 ? atoi(argv[3]) : 200000;
+    if (writers < 1 || readers < 1 || writes < 1) {
+        fprintf(stderr, "Usage: %s [writers] [readers] [writes each]\n", argv[0]);
+        return 1;
+    }
+
+    Shared *sh = mmap(NULL, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (sh == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    write_table(&sh->table, 0);
+
+    for (int r = 0; r < readers; r++) {
+        if (fork() == 0) {
+            reader(sh, writers);
+            _exit(0);
+        }
+    }
+    if (fork() == 0) {
+        unlocked_reader(sh, writers);
+        _exit(0);
+    }
+    for (int w = 0; w < writers; w++) {
+        if (fork() == 0) {
+            writer(sh, w, writers, writes);
+            _exit(0);
+        }
+    }
+    atomic_store(&sh->go, 1);
+    while (wait(NULL) > 0) {}
+
+    long torn = atomic_load(&sh->torn);
+    bool last_ok = atomic_load(&sh->table.seq) == 2u * ((unsigned)writers * writes + 1);
+    printf("test_snapshot: %d writers x %d writes, %d readers, %ld snapshots: %ld torn%s "
+           "(%ld torn without the seqlock)\n",
+           writers, writes, readers, atomic_load(&sh->snapshots), torn,
+           last_ok ? "" : ", writes lost", atomic_load(&sh->unlocked_torn));
+    return (torn || !last_ok) ? 1 : 0;
+}